@@ -0,0 +1,74 @@
+"""
+
+Author: Arthur Wesley
+
+Synthetic benchmark for very large game trees.
+
+Generates an SGF file with a number of long variations (by default 10 variations of 100,000 moves each, ie. 10^6
+nodes at a depth of 10^5) and times loading, walking and dumping it.
+
+usage: python benchmarks/huge_trees.py [variations] [depth]
+
+"""
+
+import sys
+import time
+
+from sente import sgf
+
+
+LETTERS = "abcdefghijklmnopqrs"
+
+
+def variation(depth, offset):
+    """
+
+    generates the text of a single variation
+
+    :param depth: number of moves in the variation
+    :param offset: offset applied to the move co-ordinates so that each variation starts with a different move
+    :return: SGF text of the variation
+    """
+
+    return "".join(";{}[{}{}]".format("BW"[i % 2],
+                                      LETTERS[(i + offset) % 19],
+                                      LETTERS[(i + offset) // 19 % 19]) for i in range(depth))
+
+
+def timed(label, function, *args):
+    """
+
+    times a function call and prints the result
+
+    :param label: label to print
+    :param function: function to time
+    :param args: arguments to pass to the function
+    :return: the result of the function
+    """
+
+    start = time.perf_counter()
+    result = function(*args)
+    print("{:<10} {:8.3f}s".format(label, time.perf_counter() - start))
+    return result
+
+
+def main():
+
+    variations = int(sys.argv[1]) if len(sys.argv) > 1 else 10
+    depth = int(sys.argv[2]) if len(sys.argv) > 2 else 100000
+
+    text = "(;GM[1]FF[4]SZ[19]" + "".join("(" + variation(depth, 7 * i) + ")" for i in range(variations)) + ")"
+
+    print("{} variations of {} moves ({} nodes)".format(variations, depth, variations * depth))
+
+    game = timed("load", sgf.loads, text)
+    timed("walk", game.get_all_sequences)
+    timed("dump", sgf.dumps, game)
+
+    start = time.perf_counter()
+    del game
+    print("{:<10} {:8.3f}s".format("teardown", time.perf_counter() - start))
+
+
+if __name__ == "__main__":
+    main()
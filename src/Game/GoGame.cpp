@@ -6,11 +6,13 @@
 #include <memory>
 #include <sstream>
 #include <iomanip>
+#include <optional>
 
 // #Include <pybind11/pybind11.h>
 
 #include "GoGame.h"
 #include "LifeAndDeath.h"
+#include "../Utils/SGF/SGF.h"
 #include "../Utils/SenteExceptions.h"
 
 namespace std {
@@ -70,14 +72,15 @@ namespace sente {
 
     }
 
-    GoGame::GoGame(utils::Tree<SGF::SGFNode> &SGFTree) {
-        gameTree = SGFTree;
+    GoGame::GoGame(utils::Tree<SGF::SGFNode> SGFTree) {
+        gameTree = std::move(SGFTree);
 
-        auto rootNode = gameTree.getRoot();
+        // the root's values are read in place rather than copied
+        const auto& rootNode = gameTree.getRoot();
 
         if (rootNode.hasProperty(SGF::SZ)){
             // parse if available
-            makeBoard(std::stoi(rootNode.getProperty(SGF::SZ)[0]));
+            makeBoard(std::stoi(rootNode.getFirstValue(SGF::SZ)));
         }
         else {
             // default board size
@@ -86,19 +89,19 @@ namespace sente {
 
         if (rootNode.hasProperty(SGF::RU)){
 
-            std::string ruleString = rootNode.getProperty(SGF::RU)[0];
-            rules = rulesFromStr(ruleString);
+            rules = rulesFromStr(rootNode.getFirstValue(SGF::RU));
         }
         else {
             rules = CHINESE; // default
         }
 
         if (rootNode.hasProperty(SGF::KM)){
-            if (rootNode.getProperty(SGF::KM)[0].empty()){
+            const auto& komiString = rootNode.getFirstValue(SGF::KM);
+            if (komiString.empty()){
                 komi = 0;
             }
             else {
-                komi = std::stod(rootNode.getProperty(SGF::KM)[0]);
+                komi = std::stod(komiString);
             }
         }
         else {
@@ -106,6 +109,18 @@ namespace sente {
         }
     }
 
+    /**
+     *
+     * creates a lazily loaded game (see SGF::loadLazily)
+     *
+     * @param SGFTree tree of the game's main line
+     * @param unparsedVariations side variations that have not been parsed yet
+     */
+    GoGame::GoGame(utils::Tree<SGF::SGFNode> SGFTree, std::shared_ptr<SGF::UnparsedVariations> unparsedVariations)
+        : GoGame(std::move(SGFTree)){
+        this->unparsedVariations = std::move(unparsedVariations);
+    }
+
     /**
      *
      * resets the board to be empty
@@ -176,7 +191,14 @@ namespace sente {
      */
     void GoGame::playStone(const Move &move) {
 
-        py::gil_scoped_release release;
+        // games may also be replayed on worker threads that have never held the GIL
+        std::optional<py::gil_scoped_release> release;
+        if (PyGILState_Check()){
+            release.emplace();
+        }
+
+        // the move may step into a variation that hasn't been parsed yet
+        parseVariations(gameTree.getCursor());
 
         // create a new SGF node
         SGF::SGFNode node(move);
@@ -335,14 +357,17 @@ namespace sente {
             throw std::domain_error("Cannot step up past root");
         }
 
-        // get the moves that lead to this sequence
-        auto sequence = getMoveSequence();
+        // get the nodes that lead to this position, without the last few moves
+        auto path = gameTree.getPath();
+        path.resize(path.size() - steps);
 
         // reset the board
         resetBoard();
 
         // play out the move sequence without the last few moves
-        playMoveSequence(std::vector<Move>(sequence.begin(), sequence.end() - steps));
+        for (utils::NodeID node : path){
+            playStone(gameTree.getPayload(node).getMove());
+        }
 
     }
 
@@ -360,7 +385,8 @@ namespace sente {
 
     void GoGame::playMoveSequence(const std::vector<Move>& moves) {
 
-        auto baseMoveSequence = getMoveSequence();
+        // remember the nodes leading to the current position in case we need to roll back
+        auto basePath = gameTree.getPath();
 
         try {
             // play all the stones in the sequence
@@ -371,8 +397,8 @@ namespace sente {
         catch (const utils::IllegalMoveException& except){
             // reset to the original position
             resetBoard();
-            for (const auto& move : baseMoveSequence){
-                playStone(move);
+            for (utils::NodeID node : basePath){
+                playStone(gameTree.getPayload(node).getMove());
             }
 
             // throw the exception again
@@ -380,6 +406,109 @@ namespace sente {
         }
     }
 
+    /**
+     *
+     * adds a node to the game tree below any node (ie. as a live game is being read)
+     *
+     * if the board is at the parent and the node continues the main line from it, the board moves into the node too,
+     * so a game that is being followed stays at the latest position without being replayed
+     *
+     * @param parent node to add the node below
+     * @param node node to add (merged with an existing child with the same move)
+     * @return the id of the node in the tree
+     */
+    utils::NodeID GoGame::appendNode(utils::NodeID parent, const SGF::SGFNode& node){
+
+        utils::NodeID child = gameTree.insertChild(parent, node);
+
+        if (gameTree.getCursor() != parent or gameTree.getFirstChild(parent) != child){
+            return child;
+        }
+
+        Move move = node.getMove();
+
+        if (move == Move::nullMove){
+            // nodes without a move (ie. comments) don't change the board
+            gameTree.stepToChild(child);
+        }
+        else if (move.isPass() or isLegal(move)){
+            playStone(move);
+        }
+        // the board stays where it is after an illegal move
+
+        return child;
+
+    }
+
+    /**
+     *
+     * gets the nodes of a line of the game tree
+     *
+     * @param mainLine whether to get the main line (the first child of every node from the root) rather than the
+     *                 line that leads to the current position
+     * @return the nodes of the line, starting below the root
+     */
+    std::vector<utils::NodeID> GoGame::getLine(bool mainLine) const {
+
+        if (not mainLine){
+            return gameTree.getPath();
+        }
+
+        std::vector<utils::NodeID> line;
+
+        for (utils::NodeID node = gameTree.getFirstChild(utils::ROOT_NODE); node != utils::NO_NODE;
+             node = gameTree.getFirstChild(node)){
+            line.push_back(node);
+        }
+
+        return line;
+
+    }
+
+    /**
+     *
+     * plays through a line of the game tree from the root, then puts the board back where it was
+     *
+     * @param line nodes of the line (as returned by getLine)
+     * @param beforeMove called with each move of the line while the board is at the position that it is played from
+     */
+    void GoGame::replayLine(const std::vector<utils::NodeID>& line,
+                            const std::function<void(const Move&)>& beforeMove){
+
+        auto basePath = gameTree.getPath();
+
+        auto followLine = [&](const std::vector<utils::NodeID>& nodes, bool visit){
+            for (utils::NodeID node : nodes){
+                Move move = gameTree.getPayload(node).getMove();
+                if (move == Move::nullMove){
+                    // nodes without a move (ie. comments) don't change the board
+                    gameTree.stepToChild(node);
+                    continue;
+                }
+                if (visit){
+                    beforeMove(move);
+                }
+                playStone(move);
+            }
+        };
+
+        resetBoard();
+
+        try {
+            followLine(line, true);
+        }
+        catch (const utils::IllegalMoveException&){
+            // put the board back and throw the exception again
+            resetBoard();
+            followLine(basePath, false);
+            throw;
+        }
+
+        resetBoard();
+        followLine(basePath, false);
+
+    }
+
     void GoGame::setASCIIMode(bool useASCII) {
         board->setUseASCII(useASCII);
     }
@@ -389,6 +518,8 @@ namespace sente {
 
     std::vector<Move> GoGame::getBranches() {
 
+        parseVariations(gameTree.getCursor());
+
         auto children = gameTree.getChildren();
         std::vector<Move> branches(children.size());
 
@@ -401,11 +532,11 @@ namespace sente {
 
     std::vector<Move> GoGame::getMoveSequence() {
 
-        auto sequence = gameTree.getSequence();
-        std::vector<Move> moveSequence(sequence.size());
+        const auto& path = gameTree.getPath();
+        std::vector<Move> moveSequence(path.size());
 
-        for (unsigned i = 0; i < sequence.size(); i++){
-            moveSequence[i] = sequence[i].getMove();
+        for (unsigned i = 0; i < path.size(); i++){
+            moveSequence[i] = gameTree.getPayload(path[i]).getMove();
         }
 
         return moveSequence;
@@ -416,19 +547,10 @@ namespace sente {
 
         std::vector<Move> defaultBranch;
 
-        auto bookmark = gameTree.getSequence();
-
-        while (not gameTree.isAtLeaf()){
-            auto child = gameTree.getChildren()[0];
-            defaultBranch.push_back(child.getMove());
-            gameTree.stepDown();
-        }
-
-        // now that we have found the sequence, return to our original position
-        gameTree.advanceToRoot();
-        for (const auto& move : bookmark){
-            SGF::SGFNode node(move);
-            gameTree.stepTo(node);
+        // follow the first children down from the cursor without moving it
+        for (utils::NodeID node = gameTree.getFirstChild(gameTree.getCursor());
+             node != utils::NO_NODE; node = gameTree.getFirstChild(node)){
+            defaultBranch.push_back(gameTree.getPayload(node).getMove());
         }
 
         return defaultBranch;
@@ -437,32 +559,50 @@ namespace sente {
 
     std::vector<std::vector<Move>> GoGame::getSequences(const std::vector<Move>& currentSequence) {
 
-        std::vector<std::vector<Move>> sequences;
+        utils::NodeID start = gameTree.getCursor();
+
+        parseVariationsBelow(start);
 
         if (gameTree.isAtLeaf()){
             // if we are at a leaf, set the vector to just be the current Sequence
-            sequences = {currentSequence};
+            return {currentSequence};
         }
-        else {
-            // otherwise, add all the children
-            for (auto& child : gameTree.getChildren()){
-                // copy the current sequence
-                std::vector<Move> temp(currentSequence.begin(), currentSequence.end());
 
-                // add the current move
-                temp.push_back(child.getMove());
+        std::vector<std::vector<Move>> sequences;
+        std::vector<Move> sequence(currentSequence.begin(), currentSequence.end());
+
+        // walk the subtree depth first using the sibling links rather than recursion
+        utils::NodeID node = gameTree.getFirstChild(start);
 
-                // step into the child and get its sequences
-                gameTree.stepTo(child);
-                auto childSequences = getSequences(temp);
-                gameTree.stepUp();
+        while (true){
 
-                // add all the children to the sequences
-                sequences.insert(sequences.end(), childSequences.begin(), childSequences.end());
+            // add the current move
+            sequence.push_back(gameTree.getPayload(node).getMove());
+
+            if (gameTree.getFirstChild(node) != utils::NO_NODE){
+                node = gameTree.getFirstChild(node);
+                continue;
             }
-        }
 
-        return sequences;
+            // we have reached a leaf, so this is a complete sequence
+            sequences.push_back(sequence);
+
+            // back up until we find a node with a sibling that has not been visited yet
+            while (true){
+                sequence.pop_back();
+
+                if (gameTree.getNextSibling(node) != utils::NO_NODE){
+                    node = gameTree.getNextSibling(node);
+                    break;
+                }
+
+                node = gameTree.getParent(node);
+
+                if (node == start){
+                    return sequences;
+                }
+            }
+        }
 
     }
 
@@ -470,28 +610,96 @@ namespace sente {
         return gameTree.getDepth();
     }
 
-    utils::Tree<SGF::SGFNode> GoGame::getMoveTree() const {
+    const utils::Tree<SGF::SGFNode>& GoGame::getMoveTree() const {
         return gameTree;
     }
 
-    std::unordered_map<std::string, std::vector<std::string>> GoGame::getProperties() const {
+    bool GoGame::hasUnparsedVariations() const {
+        return unparsedVariations != nullptr;
+    }
 
-        // get the properties from the root node
-        auto node = gameTree.getRoot();
+    /**
+     *
+     * parses every side variation of a lazily loaded game
+     *
+     */
+    void GoGame::parseVariations(){
+        parseVariationsBelow(utils::ROOT_NODE);
+    }
 
-        std::unordered_map<std::string, std::vector<std::string>> properties;
+    /**
+     *
+     * parses the side variations that branch from a node, if there are any
+     *
+     * @param node node to parse the variations of
+     */
+    void GoGame::parseVariations(utils::NodeID node){
 
-        for (const auto& property : node.getProperties()){
-            properties[SGF::toStr(property.first)] = property.second;
+        if (unparsedVariations == nullptr or unparsedVariations->ranges.count(node) == 0){
+            return;
         }
 
-        // add the properties from this node
-        node = gameTree.get();
+        if (unparsedVariations.use_count() > 1){
+            // copies of this game share the unparsed variations, so they need their own before they change
+            unparsedVariations = std::make_shared<SGF::UnparsedVariations>(*unparsedVariations);
+        }
+
+        SGF::parseVariations(gameTree, *unparsedVariations, node);
 
-        for (const auto& property : node.getProperties()){
-            properties[SGF::toStr(property.first)] = property.second;
+        if (unparsedVariations->ranges.empty()){
+            // everything has been parsed, so the text of the file is no longer needed
+            unparsedVariations.reset();
         }
 
+    }
+
+    /**
+     *
+     * parses every side variation in the subtree of a node
+     *
+     * @param start root of the subtree
+     */
+    void GoGame::parseVariationsBelow(utils::NodeID start){
+
+        std::stack<utils::NodeID> nodes;
+        nodes.push(start);
+
+        // parsing a variation adds its nodes to the subtree, so they are visited as well
+        while (unparsedVariations != nullptr and not nodes.empty()){
+
+            utils::NodeID node = nodes.top();
+            nodes.pop();
+
+            parseVariations(node);
+
+            for (utils::NodeID child = gameTree.getFirstChild(node); child != utils::NO_NODE;
+                 child = gameTree.getNextSibling(child)){
+                nodes.push(child);
+            }
+        }
+
+    }
+
+    std::unordered_map<std::string, std::vector<std::string>> GoGame::getProperties() const {
+
+        std::unordered_map<std::string, std::vector<std::string>> properties;
+
+        auto addProperties = [&](const SGF::SGFNode& node){
+            for (const auto& [property, values] : node.getProperties()){
+                auto& strings = properties[SGF::toStr(property)];
+                strings.clear();
+                for (const auto& value : values){
+                    strings.push_back(*value);
+                }
+            }
+        };
+
+        // get the properties from the root node
+        addProperties(gameTree.getRoot());
+
+        // add the properties from this node
+        addProperties(gameTree.get());
+
         return properties;
 
     }
@@ -596,7 +804,7 @@ namespace sente {
         }
         else {
             // obtain the winner from the property
-            return gameTree.getRoot().getProperty(SGF::RE).at(0).at(0) == 'B' ? BLACK : WHITE;
+            return gameTree.getRoot().getFirstValue(SGF::RE).at(0) == 'B' ? BLACK : WHITE;
         }
     }
 
@@ -694,7 +902,7 @@ namespace sente {
 
     std::string GoGame::getResult() const {
         if (isOver()){
-            return getProperties().at("RE")[0];
+            return gameTree.getRoot().getProperty(SGF::RE)[0];
         }
         else {
             throw std::domain_error("game is not yet over, results cannot be obtained");
@@ -717,7 +925,11 @@ namespace sente {
     }
 
     std::vector<Move> GoGame::getLegalMoves() {
-        py::gil_scoped_release release;
+
+        std::optional<py::gil_scoped_release> release;
+        if (PyGILState_Check()){
+            release.emplace();
+        }
 
         // go through the entire board
         Stone player = getActivePlayer();
@@ -754,7 +966,7 @@ namespace sente {
             return "";
         }
     };
-    void GoGame::setComment(const std::string& comment) const {
+    void GoGame::setComment(const std::string& comment) {
         gameTree.get().setProperty(SGF::C, {comment});
     };
 
@@ -889,29 +1101,19 @@ namespace sente {
     }
 
     bool GoGame::isCorrectColor(const Move &move) {
-        // go through the tree until we get our parents
-        std::stack<SGF::SGFNode> previousMoves;
 
-        while (gameTree.get().getMove() == Move::nullMove and not gameTree.isAtRoot()){
-            previousMoves.push(gameTree.get());
-            gameTree.stepUp();
-        }
-
-        bool result;
-
-        if (gameTree.isAtRoot()){
-            result = move.getStone() == BLACK;
-        }
-        else {
-            result = move.getStone() != gameTree.get().getMove().getStone();
-        }
+        // go back through the path until we find the last node that contains a move
+        const auto& path = gameTree.getPath();
 
-        while (not previousMoves.empty()){
-            gameTree.stepTo(previousMoves.top());
-            previousMoves.pop();
+        for (auto node = path.rbegin(); node != path.rend(); node++){
+            Move previousMove = gameTree.getPayload(*node).getMove();
+            if (previousMove != Move::nullMove){
+                return move.getStone() != previousMove.getStone();
+            }
         }
 
-        return result;
+        // if there are no previous moves, black plays first
+        return move.getStone() == BLACK;
     }
 
     bool GoGame::isNotSelfCapture(const Move &move) const{
@@ -9,6 +9,7 @@
 #include <vector>
 #include <memory>
 #include <fstream>
+#include <functional>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -34,13 +35,18 @@ namespace std {
 
 }
 
+namespace sente::SGF {
+    struct UnparsedVariations;
+}
+
 namespace sente {
 
     class GoGame {
     public:
 
         GoGame(unsigned side, Rules rules, double komi);
-        explicit GoGame(utils::Tree<SGF::SGFNode>& SGFTree);
+        explicit GoGame(utils::Tree<SGF::SGFNode> SGFTree);
+        GoGame(utils::Tree<SGF::SGFNode> SGFTree, std::shared_ptr<SGF::UnparsedVariations> unparsedVariations);
 
         void resetBoard();
 
@@ -78,7 +84,15 @@ namespace sente {
         std::vector<std::vector<Move>> getSequences(const std::vector<Move>& currentSequence);
 
         unsigned getMoveNumber() const;
-        utils::Tree<SGF::SGFNode> getMoveTree() const;
+        const utils::Tree<SGF::SGFNode>& getMoveTree() const;
+
+        bool hasUnparsedVariations() const;
+        void parseVariations();
+
+        utils::NodeID appendNode(utils::NodeID parent, const SGF::SGFNode& node);
+
+        [[nodiscard]] std::vector<utils::NodeID> getLine(bool mainLine) const;
+        void replayLine(const std::vector<utils::NodeID>& line, const std::function<void(const Move&)>& beforeMove);
 
         ///
         /// Getting and setting properties
@@ -90,7 +104,7 @@ namespace sente {
         void setProperty(const std::string& command, const std::vector<std::string>& values);
 
         std::string getComment() const;
-        void setComment(const std::string& comment) const;
+        void setComment(const std::string& comment);
 
         ///
         /// Getter and Setter methods
@@ -137,6 +151,9 @@ namespace sente {
 
         utils::Tree<SGF::SGFNode> gameTree; // 32 bytes
 
+        // side variations of a lazily loaded game that have not been parsed yet (null if there are none)
+        std::shared_ptr<SGF::UnparsedVariations> unparsedVariations; // 16 bytes
+
         std::unordered_map<Move, std::shared_ptr<Group>> groups; // 40 bytes
         std::unordered_map<unsigned, std::unordered_set<Move>> capturedStones; // 40 bytes
 
@@ -144,6 +161,9 @@ namespace sente {
 
         Move koPoint;
 
+        void parseVariations(utils::NodeID node);
+        void parseVariationsBelow(utils::NodeID start);
+
         void makeBoard(unsigned side);
         void clearBoard();
         void resetKoPoint();
@@ -79,15 +79,23 @@ namespace sente::utils {
                             const _board& board,
                             std::unordered_set<Move>& foundConnections) {
 
+        // flood fill with an explicit stack of moves whose neighbors have not been checked yet
+        std::vector<Move> frontier{startMove};
+
         // insert the current move into the list of found moves
         foundConnections.insert(startMove);
 
-        for (const auto& point : startMove.getAdjacentMoves(board.getSide())){
-            Move move = board.getSpace(point);
-            // if we haven't seen the move before and the color of the stone is correct
-            if (foundConnections.find(move) == foundConnections.end() and move.getStone() == startMove.getStone()){
-                // insert this stone and all of it's children into the set
-                getConnectedPoints(move, board, foundConnections);
+        while (not frontier.empty()){
+
+            Move current = frontier.back();
+            frontier.pop_back();
+
+            for (const auto& point : current.getAdjacentMoves(board.getSide())){
+                Move move = board.getSpace(point);
+                // if we haven't seen the move before and the color of the stone is correct
+                if (move.getStone() == startMove.getStone() and foundConnections.insert(move).second){
+                    frontier.push_back(move);
+                }
             }
         }
     }
@@ -155,6 +155,18 @@ namespace sente {
         return adjacents;
     }
 
+    /**
+     *
+     * packs the move into 16 bits (2 bits of stone, 5 bits each of x and y)
+     *
+     * every legal move, pass and resignation has a distinct code
+     *
+     * @return the code of the move
+     */
+    uint16_t Move::getCode() const {
+        return uint16_t((unsigned(stone) << 10) | ((x & 31) << 5) | (y & 31));
+    }
+
     std::string Move::toSGF() const {
 
         std::stringstream str;
@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 #include <sstream>
 #include <ciso646>
 #include <functional>
@@ -74,6 +75,8 @@ namespace sente {
         Vertex getVertex() const;
         std::vector<Vertex> getAdjacentMoves(unsigned boardSize) const;
 
+        uint16_t getCode() const;
+
         explicit operator std::string() const;
         std::string toSGF() const;
 
@@ -0,0 +1,307 @@
+//
+// Created on 10/18/26.
+//
+
+#include <ciso646>
+#include <algorithm>
+
+#include "Zobrist.h"
+
+namespace sente {
+
+    // largest board that positions are hashed on
+    const unsigned MAX_SIDE = 19;
+
+    /**
+     *
+     * mixes the bits of a hash (the finalizer of splitmix64)
+     *
+     */
+    uint64_t mixHash(uint64_t hash){
+        hash += 0x9E3779B97F4A7C15ULL;
+        hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+        return hash ^ (hash >> 31);
+    }
+
+    /**
+     *
+     * applies one of the 8 symmetries of the board to a point
+     *
+     * symmetries 0 to 3 are reflections across the axes (0 is the identity), 4 to 7 are the same reflections
+     * of the transposed board
+     *
+     * @param x x co-ordinate of the point
+     * @param y y co-ordinate of the point
+     * @param symmetry index of the symmetry (from 0 to 7)
+     * @param side size of the board
+     * @return the transformed point
+     */
+    Vertex transformVertex(unsigned x, unsigned y, unsigned symmetry, unsigned side){
+
+        unsigned last = side - 1;
+
+        if (symmetry >= 4){
+            std::swap(x, y);
+        }
+        if (symmetry & 1){
+            x = last - x;
+        }
+        if (symmetry & 2){
+            y = last - y;
+        }
+
+        return {x, y};
+
+    }
+
+    /**
+     *
+     * finds the symmetry that undoes a symmetry
+     *
+     * @param symmetry index of the symmetry
+     * @return index of the inverse symmetry
+     */
+    unsigned inverseSymmetry(unsigned symmetry){
+        // transposing and then reflecting one axis is a rotation, which is undone by reflecting the other axis
+        if (symmetry == 5){
+            return 6;
+        }
+        if (symmetry == 6){
+            return 5;
+        }
+        return symmetry;
+    }
+
+    /**
+     *
+     * applies a symmetry to a move, moves that aren't on the board (ie. passes) are unchanged
+     *
+     */
+    Move transformMove(const Move& move, unsigned symmetry, unsigned side){
+        if (move.getX() >= side or move.getY() >= side){
+            return move;
+        }
+        return {transformVertex(move.getX(), move.getY(), symmetry, side), move.getStone()};
+    }
+
+    /**
+     *
+     * the random key of a stone on a point
+     *
+     * the keys are generated from a fixed seed so that hashes are the same on every machine (and can be saved)
+     *
+     */
+    uint64_t zobristKey(unsigned x, unsigned y, Stone stone){
+
+        static const auto keys = [](){
+            std::array<uint64_t, 2 * MAX_SIDE * MAX_SIDE> table{};
+            uint64_t state = 0x5E47E5E47E5E47EULL;
+            for (auto& key : table){
+                state = mixHash(state);
+                key = state;
+            }
+            return table;
+        }();
+
+        return keys[(stone == WHITE ? MAX_SIDE * MAX_SIDE : 0) + x * MAX_SIDE + y];
+
+    }
+
+    /**
+     *
+     * the key of the player whose turn it is
+     *
+     */
+    uint64_t zobristPlayerKey(Stone player){
+        return player == WHITE ? 0xC0FFEE5E47E0C0DEULL : 0;
+    }
+
+    /**
+     *
+     * computes the zobrist hash of a position under each of the 8 symmetries of the board
+     *
+     * the hash includes the size of the board and the player to move
+     *
+     * @param game game whose current position is hashed
+     * @return the hash of the transformed position for each symmetry
+     */
+    std::array<uint64_t, SYMMETRY_COUNT> symmetricHashes(const GoGame& game){
+
+        unsigned side = game.getSide();
+
+        std::array<uint64_t, SYMMETRY_COUNT> hashes{};
+        hashes.fill(mixHash(side) ^ zobristPlayerKey(game.getActivePlayer()));
+
+        for (unsigned x = 0; x < side; x++){
+            for (unsigned y = 0; y < side; y++){
+                Stone stone = game.getSpace(x, y);
+                if (stone != EMPTY){
+                    for (unsigned symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++){
+                        auto point = transformVertex(x, y, symmetry, side);
+                        hashes[symmetry] ^= zobristKey(point.getX(), point.getY(), stone);
+                    }
+                }
+            }
+        }
+
+        return hashes;
+
+    }
+
+    /**
+     *
+     * finds the symmetry with the smallest hash, which is the same for every rotation or reflection of a position
+     *
+     * @param hashes hashes of a position under each symmetry
+     * @return the index of the symmetry
+     */
+    unsigned canonicalSymmetry(const std::array<uint64_t, SYMMETRY_COUNT>& hashes){
+        return unsigned(std::min_element(hashes.begin(), hashes.end()) - hashes.begin());
+    }
+
+    // corners of the board are hashed as squares of up to this size
+    const unsigned MAX_CORNER_SIZE = 7;
+
+    // keys that separate the hashes of whole boards and of corners
+    const uint64_t BOARD_KEY = 0xB0A2DB0A2DB0A2DULL;
+    const uint64_t CORNER_KEY = 0xC02E2C02E2C02E2ULL;
+
+    PositionHasher::PositionHasher(unsigned side) : side(side){
+
+        // the corners of small boards are smaller so that they don't cover most of the board
+        cornerSize = std::min(MAX_CORNER_SIZE, (side + 1) / 2);
+
+        stones.assign(side * side, EMPTY);
+
+        boardHashes.fill(mixHash(BOARD_KEY ^ side));
+
+        unsigned last = side - 1;
+
+        for (unsigned corner = 0; corner < 4; corner++){
+
+            unsigned cornerX = corner & 1 ? last : 0;
+            unsigned cornerY = corner & 2 ? last : 0;
+
+            // exactly two symmetries move the corner point to the origin (one is the transpose of the other)
+            unsigned found = 0;
+            for (unsigned symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++){
+                auto point = transformVertex(cornerX, cornerY, symmetry, side);
+                if (point.getX() == 0 and point.getY() == 0){
+                    cornerSymmetries[corner][found++] = symmetry;
+                }
+            }
+
+            cornerHashes[corner].fill(mixHash(CORNER_KEY ^ side ^ (uint64_t(cornerSize) << 8)));
+        }
+
+    }
+
+    /**
+     *
+     * adds or removes a stone from the hashes
+     *
+     */
+    void PositionHasher::toggle(unsigned x, unsigned y, Stone stone){
+
+        Stone opponent = getOpponent(stone);
+
+        for (unsigned symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++){
+            auto point = transformVertex(x, y, symmetry, side);
+            boardHashes[symmetry] ^= zobristKey(point.getX(), point.getY(), stone);
+            boardHashes[SYMMETRY_COUNT + symmetry] ^= zobristKey(point.getX(), point.getY(), opponent);
+        }
+
+        for (unsigned corner = 0; corner < 4; corner++){
+
+            // the corner's own symmetries move the corner's points to the square at the origin
+            auto point = transformVertex(x, y, cornerSymmetries[corner][0], side);
+            if (point.getX() >= cornerSize or point.getY() >= cornerSize){
+                continue;
+            }
+
+            for (unsigned i = 0; i < 2; i++){
+                point = transformVertex(x, y, cornerSymmetries[corner][i], side);
+                cornerHashes[corner][i] ^= zobristKey(point.getX(), point.getY(), stone);
+                cornerHashes[corner][2 + i] ^= zobristKey(point.getX(), point.getY(), opponent);
+            }
+        }
+
+    }
+
+    /**
+     *
+     * brings the hashes up to date with the current position of a game
+     *
+     * @param game game being replayed (on a board of the same size as the hasher)
+     */
+    void PositionHasher::update(const GoGame& game){
+
+        for (unsigned x = 0; x < side; x++){
+            for (unsigned y = 0; y < side; y++){
+
+                Stone& current = stones[x * side + y];
+                Stone stone = game.getSpace(x, y);
+
+                if (stone == current){
+                    continue;
+                }
+
+                // remove the old stone and add the new one
+                if (current != EMPTY){
+                    toggle(x, y, current);
+                    stoneCount--;
+                }
+                if (stone != EMPTY){
+                    toggle(x, y, stone);
+                    stoneCount++;
+                }
+
+                for (unsigned corner = 0; corner < 4; corner++){
+                    auto point = transformVertex(x, y, cornerSymmetries[corner][0], side);
+                    if (point.getX() < cornerSize and point.getY() < cornerSize){
+                        cornerStones[corner] += (stone != EMPTY);
+                        cornerStones[corner] -= (current != EMPTY);
+                    }
+                }
+
+                current = stone;
+            }
+        }
+
+    }
+
+    bool PositionHasher::isEmpty() const {
+        return stoneCount == 0;
+    }
+
+    /**
+     *
+     * the hash of the whole board, which is the same for every rotation or reflection of the position as well as when
+     * the colors of the stones are swapped (the player to move is not included)
+     *
+     */
+    uint64_t PositionHasher::getBoardHash() const {
+        return *std::min_element(boardHashes.begin(), boardHashes.end());
+    }
+
+    unsigned PositionHasher::getCornerSize() const {
+        return cornerSize;
+    }
+
+    bool PositionHasher::isCornerEmpty(unsigned corner) const {
+        return cornerStones[corner] == 0;
+    }
+
+    /**
+     *
+     * the hash of a corner of the board, which is the same for a pattern in any corner, in either orientation and with
+     * either color
+     *
+     * @param corner index of the corner (0 to 3)
+     */
+    uint64_t PositionHasher::getCornerHash(unsigned corner) const {
+        return *std::min_element(cornerHashes[corner].begin(), cornerHashes[corner].end());
+    }
+
+}
@@ -0,0 +1,78 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_ZOBRIST_H
+#define SENTE_ZOBRIST_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+#include "Move.h"
+#include "GoGame.h"
+
+namespace sente {
+
+    // rotations and reflections of the board
+    const unsigned SYMMETRY_COUNT = 8;
+
+    uint64_t mixHash(uint64_t hash);
+
+    Vertex transformVertex(unsigned x, unsigned y, unsigned symmetry, unsigned side);
+    unsigned inverseSymmetry(unsigned symmetry);
+    Move transformMove(const Move& move, unsigned symmetry, unsigned side);
+
+    uint64_t zobristKey(unsigned x, unsigned y, Stone stone);
+    uint64_t zobristPlayerKey(Stone player);
+
+    std::array<uint64_t, SYMMETRY_COUNT> symmetricHashes(const GoGame& game);
+    unsigned canonicalSymmetry(const std::array<uint64_t, SYMMETRY_COUNT>& hashes);
+
+    /**
+     *
+     * keeps the hashes of the whole board and of each corner of a game up to date as the game is replayed
+     *
+     * the hashes are the same for every rotation or reflection of a position and when the colors of the stones are
+     * swapped, so they can be used to search for a position without knowing its orientation. rather than re-hashing
+     * the whole board after every move, only the points that changed since the last update are hashed.
+     *
+     */
+    class PositionHasher {
+    public:
+
+        explicit PositionHasher(unsigned side);
+
+        void update(const GoGame& game);
+
+        [[nodiscard]] bool isEmpty() const;
+        [[nodiscard]] uint64_t getBoardHash() const;
+
+        [[nodiscard]] unsigned getCornerSize() const;
+        [[nodiscard]] bool isCornerEmpty(unsigned corner) const;
+        [[nodiscard]] uint64_t getCornerHash(unsigned corner) const;
+
+    private:
+
+        unsigned side;
+        unsigned cornerSize;
+
+        std::vector<Stone> stones;
+        unsigned stoneCount = 0;
+
+        // hash of the board under each symmetry, followed by the same hashes with the colors swapped
+        std::array<uint64_t, 2 * SYMMETRY_COUNT> boardHashes{};
+
+        // the two symmetries that move each corner to the corner at the origin
+        std::array<std::array<unsigned, 2>, 4> cornerSymmetries{};
+        // hash of each corner under both of its symmetries, followed by the same hashes with the colors swapped
+        std::array<std::array<uint64_t, 4>, 4> cornerHashes{};
+        std::array<unsigned, 4> cornerStones{};
+
+        void toggle(unsigned x, unsigned y, Stone stone);
+
+    };
+
+}
+
+#endif //SENTE_ZOBRIST_H
@@ -0,0 +1,153 @@
+//
+// Created on 10/18/26.
+//
+
+#include <cstdio>
+#include <random>
+#include <fstream>
+#include <ciso646>
+#include <algorithm>
+
+#include <zlib.h>
+
+#include "Compression.h"
+#include "SenteExceptions.h"
+
+namespace sente::utils {
+
+    // size of the chunks that files are read and written in
+    const unsigned CHUNK_SIZE = 1 << 16;
+
+    /**
+     *
+     * reads the entire contents of a file, decompressing it if it is gzipped
+     *
+     * zlib detects the gzip header by itself and passes files without one through unchanged, so plain and compressed
+     * files are read the same way
+     *
+     * @param fileName path to the file
+     * @return the (decompressed) contents of the file
+     */
+    std::string readFile(const std::string& fileName){
+
+        gzFile file = gzopen(fileName.c_str(), "rb");
+
+        if (file == nullptr){
+            throw FileNotFoundException(fileName);
+        }
+
+        gzbuffer(file, CHUNK_SIZE);
+
+        std::string contents;
+        size_t length = 0;
+        int bytesRead;
+
+        // read straight into the end of the string rather than through a (large) buffer on the stack
+        do {
+            contents.resize(length + CHUNK_SIZE);
+            bytesRead = gzread(file, contents.data() + length, CHUNK_SIZE);
+            length += std::max(bytesRead, 0);
+        } while (bytesRead > 0);
+
+        contents.resize(length);
+
+        // a truncated or corrupt stream ends the loop early and leaves an error behind
+        int error;
+        std::string message = gzerror(file, &error);
+
+        gzclose(file);
+
+        if (error != Z_OK){
+            throw InvalidSGFException(message);
+        }
+
+        return contents;
+
+    }
+
+    /**
+     *
+     * writes a string to a file, compressing it with gzip if the file name ends in ".gz"
+     *
+     * @param fileName path to the file
+     * @param contents text to write
+     */
+    void writeFile(const std::string& fileName, const std::string& contents){
+
+        bool compress = fileName.size() >= 3 and fileName.compare(fileName.size() - 3, 3, ".gz") == 0;
+
+        if (not compress){
+            std::ofstream output(fileName);
+            output << contents;
+            output.close();
+
+            // a full disk or other IO error only shows up in the state of the stream
+            if (output.fail()){
+                throw FileWriteException(fileName);
+            }
+            return;
+        }
+
+        gzFile file = gzopen(fileName.c_str(), "wb");
+
+        if (file == nullptr){
+            throw FileWriteException(fileName);
+        }
+
+        for (size_t start = 0; start < contents.size(); start += CHUNK_SIZE){
+            auto length = unsigned(std::min<size_t>(CHUNK_SIZE, contents.size() - start));
+            if (gzwrite(file, contents.data() + start, length) == 0){
+                gzclose(file);
+                throw FileWriteException(fileName);
+            }
+        }
+
+        // the end of the stream is only flushed when the file is closed
+        if (gzclose(file) != Z_OK){
+            throw FileWriteException(fileName);
+        }
+
+    }
+
+    /**
+     *
+     * writes a (binary) file by writing a temporary file next to it and then renaming the temporary file over it
+     *
+     * a crash, a full disk or a reader opening the file at the same time never sees a half written file
+     *
+     * @param fileName path to the file
+     * @param contents bytes to write
+     */
+    void replaceFile(const std::string& fileName, std::string_view contents){
+
+        // a name of its own so that processes writing the same file at once don't write the same temporary file
+        std::string temporaryName = fileName + "." + std::to_string(std::random_device()()) + ".tmp";
+
+        {
+            std::ofstream output(temporaryName, std::ios::binary);
+
+            if (not output.good()){
+                throw FileWriteException(fileName);
+            }
+
+            output.write(contents.data(), std::streamsize(contents.size()));
+            output.close();
+
+            if (output.fail()){
+                std::remove(temporaryName.c_str());
+                throw FileWriteException(fileName);
+            }
+        }
+
+        if (std::rename(temporaryName.c_str(), fileName.c_str()) != 0){
+            // windows won't rename over an existing file
+            std::remove(fileName.c_str());
+            if (std::rename(temporaryName.c_str(), fileName.c_str()) != 0){
+                std::remove(temporaryName.c_str());
+                throw FileWriteException(fileName);
+            }
+        }
+
+    }
+
+}
@@ -0,0 +1,19 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_COMPRESSION_H
+#define SENTE_COMPRESSION_H
+
+#include <string>
+#include <string_view>
+
+namespace sente::utils {
+
+    std::string readFile(const std::string& fileName);
+    void writeFile(const std::string& fileName, const std::string& contents);
+    void replaceFile(const std::string& fileName, std::string_view contents);
+
+}
+
+#endif //SENTE_COMPRESSION_H
@@ -7,6 +7,8 @@
 
 #include "Operators.h"
 #include "../SGF/SGF.h"
+#include "../Compression.h"
+#include "../SenteExceptions.h"
 
 namespace sente::GTP {
 
@@ -123,7 +125,7 @@ namespace sente::GTP {
     }
     Response undoMultiple(Session* self, const std::vector<std::shared_ptr<Token>>& arguments){
         auto* steps = (Integer*) arguments[1].get();
-        if (self->masterGame.getMoveSequence().size() >= steps->getValue()){
+        if (self->masterGame.getMoveNumber() >= steps->getValue()){
             self->masterGame.stepUp(steps->getValue());
             self->setGTPDisplayFlags();
             return {true, ""};
@@ -135,21 +137,21 @@ namespace sente::GTP {
 
     Response baseLoadSGF(Session* self, const std::string& filePath){
 
-        // load the text from the file
-        std::ifstream filePointer(filePath);
+        // load the text from the file (decompressing it if it is gzipped)
+        std::string SGFText;
 
-        if (not filePointer.good()){
+        try {
+            SGFText = utils::readFile(filePath);
+        }
+        catch (const utils::FileNotFoundException&){
             return {false, "cannot load file"};
         }
 
-        std::string SGFText = std::string((std::istreambuf_iterator<char>(filePointer)),
-                                          std::istreambuf_iterator<char>());
-
         // generate the move tree
         auto tree = sente::SGF::loadSGF(SGFText, false, true, true);
 
         // set the engine's game to be the move tree
-        self->masterGame = GoGame(tree);
+        self->masterGame = GoGame(std::move(tree));
         self->setGTPDisplayFlags();
 
         return {true, ""};
@@ -0,0 +1,42 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_LITTLEENDIAN_H
+#define SENTE_LITTLEENDIAN_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sente::utils {
+
+    /**
+     *
+     * stores an unsigned integer in little endian order so that files are portable between machines
+     *
+     */
+    template<typename Integer>
+    void storeInteger(char* destination, Integer value){
+        for (size_t i = 0; i < sizeof(Integer); i++){
+            destination[i] = char(value & 0xFF);
+            value >>= 8;
+        }
+    }
+
+    /**
+     *
+     * loads an unsigned integer stored by storeInteger (ie. from a memory mapped file)
+     *
+     */
+    template<typename Integer>
+    Integer loadInteger(const char* source){
+        Integer value = 0;
+        for (size_t i = 0; i < sizeof(Integer); i++){
+            value |= Integer(uint8_t(source[i])) << (8 * i);
+        }
+        return value;
+    }
+
+}
+
+#endif //SENTE_LITTLEENDIAN_H
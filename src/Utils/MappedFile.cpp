@@ -0,0 +1,185 @@
+//
+// Created on 10/18/26.
+//
+
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include "MappedFile.h"
+#include "SenteExceptions.h"
+
+namespace sente::utils {
+
+#ifdef _WIN32
+
+    MappedFile::MappedFile(const std::string& fileName){
+
+        HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE){
+            throw FileNotFoundException(fileName);
+        }
+        fileHandle = file;
+
+        LARGE_INTEGER fileSize;
+        if (not GetFileSizeEx(file, &fileSize)){
+            unmap();
+            throw FileNotFoundException(fileName);
+        }
+        length = size_t(fileSize.QuadPart);
+
+        FILETIME lastWrite;
+        if (GetFileTime(file, nullptr, nullptr, &lastWrite)){
+            modified = (int64_t(lastWrite.dwHighDateTime) << 32) | lastWrite.dwLowDateTime;
+        }
+
+        if (length == 0){
+            // empty files can't be mapped
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr){
+            unmap();
+            throw FileNotFoundException(fileName);
+        }
+        mappingHandle = mapping;
+
+        contents = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (contents == nullptr){
+            unmap();
+            throw FileNotFoundException(fileName);
+        }
+
+    }
+
+    void MappedFile::unmap(){
+        if (contents != nullptr){
+            UnmapViewOfFile(contents);
+        }
+        if (mappingHandle != nullptr){
+            CloseHandle(mappingHandle);
+        }
+        if (fileHandle != nullptr){
+            CloseHandle(fileHandle);
+        }
+        contents = nullptr;
+        mappingHandle = nullptr;
+        fileHandle = nullptr;
+        length = 0;
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept {
+        contents = std::exchange(other.contents, nullptr);
+        length = std::exchange(other.length, 0);
+        modified = std::exchange(other.modified, 0);
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other){
+            unmap();
+            contents = std::exchange(other.contents, nullptr);
+            length = std::exchange(other.length, 0);
+            modified = std::exchange(other.modified, 0);
+            fileHandle = std::exchange(other.fileHandle, nullptr);
+            mappingHandle = std::exchange(other.mappingHandle, nullptr);
+        }
+        return *this;
+    }
+
+#else
+
+    MappedFile::MappedFile(const std::string& fileName){
+
+        int file = open(fileName.c_str(), O_RDONLY);
+        if (file < 0){
+            throw FileNotFoundException(fileName);
+        }
+
+        struct stat fileInfo{};
+        if (fstat(file, &fileInfo) != 0 or not S_ISREG(fileInfo.st_mode)){
+            close(file);
+            throw FileNotFoundException(fileName);
+        }
+        length = size_t(fileInfo.st_size);
+        modified = int64_t(fileInfo.st_mtime);
+
+        if (length != 0){
+            // empty files can't be mapped
+            void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+            if (mapping == MAP_FAILED){
+                close(file);
+                throw FileNotFoundException(fileName);
+            }
+            contents = static_cast<const char*>(mapping);
+        }
+
+        // the mapping stays valid after the file is closed
+        close(file);
+
+    }
+
+    void MappedFile::unmap(){
+        if (contents != nullptr){
+            munmap(const_cast<char*>(contents), length);
+        }
+        contents = nullptr;
+        length = 0;
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept {
+        contents = std::exchange(other.contents, nullptr);
+        length = std::exchange(other.length, 0);
+        modified = std::exchange(other.modified, 0);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other){
+            unmap();
+            contents = std::exchange(other.contents, nullptr);
+            length = std::exchange(other.length, 0);
+            modified = std::exchange(other.modified, 0);
+        }
+        return *this;
+    }
+
+#endif
+
+    MappedFile::~MappedFile(){
+        unmap();
+    }
+
+    const char* MappedFile::data() const {
+        return contents;
+    }
+
+    size_t MappedFile::size() const {
+        return length;
+    }
+
+    std::string_view MappedFile::view() const {
+        return {contents, length};
+    }
+
+    /**
+     *
+     * the time the file was last modified when it was mapped, in units that depend on the platform (so it should only
+     * be compared to other modification times from the same machine)
+     *
+     */
+    int64_t MappedFile::modificationTime() const {
+        return modified;
+    }
+
+}
@@ -0,0 +1,58 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_MAPPEDFILE_H
+#define SENTE_MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace sente::utils {
+
+    /**
+     *
+     * read only memory map of an entire file
+     *
+     * pages of the file are only read from disk when they are touched, so a small part of a very large file can be
+     * accessed without reading the rest of it
+     *
+     */
+    class MappedFile {
+    public:
+
+        explicit MappedFile(const std::string& fileName);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        [[nodiscard]] const char* data() const;
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] std::string_view view() const;
+        [[nodiscard]] int64_t modificationTime() const;
+
+    private:
+
+        const char* contents = nullptr;
+        size_t length = 0;
+        int64_t modified = 0;
+
+#ifdef _WIN32
+        void* fileHandle = nullptr;
+        void* mappingHandle = nullptr;
+#endif
+
+        void unmap();
+
+    };
+
+}
+
+#endif //SENTE_MAPPEDFILE_H
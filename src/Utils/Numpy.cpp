@@ -4,18 +4,12 @@
 
 #include <map>
 #include <ciso646>
+#include <stdexcept>
 
 #include "Numpy.h"
 
 namespace sente::utils {
 
-    enum feature {
-        BLACK_STONES,
-        WHITE_STONES,
-        EMPTY_POINTS,
-        KO_POINTS
-    };
-
     std::map<std::string, feature> featureMap {
         {"Black Stones", BLACK_STONES},
         {"White Stones", WHITE_STONES},
@@ -47,7 +41,28 @@ namespace sente::utils {
         auto result = py::array_t<int8_t>(long(side * side * features.size()));
         auto buffer = result.request(true);
 
-        auto* buffer_ptr = (int8_t*) buffer.ptr;
+        fillFeatures(game, features, (int8_t*) buffer.ptr);
+
+        result.resize({side, side, unsigned(features.size())});
+
+        return result;
+
+    }
+
+    /**
+     *
+     * write the features of a go game into a buffer
+     *
+     * this doesn't touch any python objects, so it may be called without holding the GIL
+     *
+     * @param game the game to generate the features for
+     * @param features list of features to include
+     * @param buffer_ptr buffer of side * side * features.size() bytes to write the features into (in side, side,
+     *                   feature order)
+     */
+    void fillFeatures(const GoGame& game, const std::vector<feature>& features, int8_t* buffer_ptr){
+
+        unsigned side = game.getSide();
 
         for (unsigned i = 0; i < side; i++){
             for (unsigned j = 0; j < side; j++){
@@ -76,9 +91,93 @@ namespace sente::utils {
             }
         }
 
-        result.resize({side, side, unsigned(features.size())});
+    }
 
-        return result;
+    /**
+     *
+     * write the features of a go game into a buffer with one plane per feature
+     *
+     * @param game the game to generate the features for
+     * @param features list of features to include
+     * @param buffer_ptr buffer of features.size() * side * side bytes to write the features into (in feature, side,
+     *                   side order)
+     */
+    void fillFeaturePlanes(const GoGame& game, const std::vector<feature>& features, int8_t* buffer_ptr){
+
+        unsigned side = game.getSide();
+
+        for (unsigned plane = 0; plane < features.size(); plane++){
+            for (unsigned i = 0; i < side; i++){
+                for (unsigned j = 0; j < side; j++){
+
+                    unsigned bufferIndex = (plane * side + i) * side + j;
+
+                    switch (features[plane]){
+                        case BLACK_STONES:
+                            getNextBlackStone(game, buffer_ptr, bufferIndex, {i, j});
+                            break;
+                        case WHITE_STONES:
+                            getNextWhiteStone(game, buffer_ptr, bufferIndex, {i, j});
+                            break;
+                        case EMPTY_POINTS:
+                            getNextEmptySpace(game, buffer_ptr, bufferIndex, {i, j});
+                            break;
+                        case KO_POINTS:
+                            getNextKoPoint(game, buffer_ptr, bufferIndex, {i, j});
+                            break;
+                    }
+                }
+            }
+        }
+
+    }
+
+    /**
+     *
+     * Generate the features of every position along a line of a game in a single replay
+     *
+     * @param game the game to generate the features for
+     * @param features list of features to include
+     * @param mainLine whether to use the main line of the game rather than the line to the current position
+     * @return a T x features x side x side array of the positions that each move was played from and an array of the
+     *         T moves (encoded as x * side + y, with side * side for a pass)
+     */
+    py::tuple getTensor(GoGame& game, const std::vector<std::string>& features, bool mainLine){
+
+        auto featureVector = parseFeatures(features);
+
+        unsigned side = game.getSide();
+        auto line = game.getLine(mainLine);
+
+        size_t moveCount = 0;
+        for (utils::NodeID node : line){
+            if (game.getMoveTree().getPayload(node).getMove() != Move::nullMove){
+                moveCount++;
+            }
+        }
+
+        py::array_t<uint8_t> positions({moveCount, featureVector.size(), size_t(side), size_t(side)});
+        py::array_t<int32_t> moves(moveCount);
+
+        auto* positions_ptr = (int8_t*) positions.mutable_data();
+        auto* moves_ptr = moves.mutable_data();
+
+        size_t planeSize = featureVector.size() * side * side;
+        size_t index = 0;
+
+        {
+            py::gil_scoped_release release;
+
+            game.replayLine(line, [&](const Move& move){
+
+                fillFeaturePlanes(game, featureVector, positions_ptr + index * planeSize);
+                moves_ptr[index] = move.isPass() ? int32_t(side * side) : int32_t(move.getX() * side + move.getY());
+
+                index++;
+            });
+        }
+
+        return py::make_tuple(positions, moves);
 
     }
 
@@ -173,6 +272,29 @@ namespace sente::utils {
 
     }
 
+    /**
+     *
+     * convert the names of features to features
+     *
+     * @param names names of the features (ie. "black_stones" or "Black Stones")
+     * @return the features
+     */
+    std::vector<feature> parseFeatures(const std::vector<std::string>& names){
+
+        std::vector<feature> features;
+
+        for (const auto& name : names){
+            auto found = featureMap.find(name);
+            if (found == featureMap.end()){
+                throw std::invalid_argument("Unknown feature: \"" + name + "\"");
+            }
+            features.push_back(found->second);
+        }
+
+        return features;
+
+    }
+
     py::array_t<uint8_t> getFeatures(const GoGame& game, const std::vector<std::string>& features) {
 
         auto featureVector = std::vector<feature>();
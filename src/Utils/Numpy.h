@@ -13,7 +13,19 @@
 
 namespace sente::utils {
 
+    enum feature {
+        BLACK_STONES,
+        WHITE_STONES,
+        EMPTY_POINTS,
+        KO_POINTS
+    };
+
+    std::vector<feature> parseFeatures(const std::vector<std::string>& names);
+    void fillFeatures(const GoGame& game, const std::vector<feature>& features, int8_t* buffer_ptr);
+    void fillFeaturePlanes(const GoGame& game, const std::vector<feature>& features, int8_t* buffer_ptr);
+
     py::array_t<uint8_t> getFeatures(const GoGame& game, const std::vector<std::string>& features);
+    py::tuple getTensor(GoGame& game, const std::vector<std::string>& features, bool mainLine);
 
 }
 
@@ -0,0 +1,121 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_PARALLEL_H
+#define SENTE_PARALLEL_H
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <ciso646>
+#include <algorithm>
+#include <exception>
+
+namespace sente::utils {
+
+    /**
+     *
+     * determines how many worker threads to use for a job
+     *
+     * @param threads number of threads requested (0 means one per hardware thread)
+     * @param tasks number of tasks in the job
+     * @return the number of threads to start
+     */
+    inline unsigned getThreadCount(unsigned threads, size_t tasks){
+
+        if (threads == 0){
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+
+        // never start more threads than there are tasks
+        return unsigned(std::max<size_t>(1, std::min<size_t>(threads, tasks)));
+    }
+
+    /**
+     *
+     * calls function(worker, i) for every i in [0, count) on a pool of worker threads
+     *
+     * worker is the index of the thread running the task (from 0 up to getThreadCount(threads, count)), so tasks may
+     * accumulate results into per-thread storage without locking. tasks are handed out one at a time so that uneven
+     * tasks balance themselves across the threads. if any task throws, the remaining tasks are abandoned and the
+     * exception from the task with the lowest index is re-thrown once all of the threads have finished.
+     *
+     * the function must not touch any python objects (the GIL is normally released while this runs)
+     *
+     * @param count number of tasks
+     * @param threads number of threads to use (0 means one per hardware thread)
+     * @param function function to call with the index of the worker and the index of each task
+     */
+    template<typename Function>
+    void parallelForWorkers(size_t count, unsigned threads, Function function){
+
+        if (count == 0){
+            return;
+        }
+
+        std::atomic<size_t> next{0};
+        std::atomic<bool> failed{false};
+
+        std::mutex errorLock;
+        size_t errorIndex = count;
+        std::exception_ptr error;
+
+        auto worker = [&](unsigned workerIndex){
+            for (size_t i = next++; i < count and not failed; i = next++){
+                try {
+                    function(workerIndex, i);
+                }
+                catch (...){
+                    std::lock_guard<std::mutex> guard(errorLock);
+                    if (i < errorIndex){
+                        errorIndex = i;
+                        error = std::current_exception();
+                    }
+                    failed = true;
+                }
+            }
+        };
+
+        unsigned threadCount = getThreadCount(threads, count);
+
+        if (threadCount == 1){
+            // don't bother starting a thread for serial jobs
+            worker(0);
+        }
+        else {
+            std::vector<std::thread> workers;
+            workers.reserve(threadCount);
+
+            for (unsigned i = 0; i < threadCount; i++){
+                workers.emplace_back(worker, i);
+            }
+            for (auto& thread : workers){
+                thread.join();
+            }
+        }
+
+        if (error){
+            std::rethrow_exception(error);
+        }
+    }
+
+    /**
+     *
+     * calls function(i) for every i in [0, count) on a pool of worker threads (see parallelForWorkers)
+     *
+     * @param count number of tasks
+     * @param threads number of threads to use (0 means one per hardware thread)
+     * @param function function to call with the index of each task
+     */
+    template<typename Function>
+    void parallelFor(size_t count, unsigned threads, Function function){
+        parallelForWorkers(count, threads, [&](unsigned, size_t i){
+            function(i);
+        });
+    }
+
+}
+
+#endif //SENTE_PARALLEL_H
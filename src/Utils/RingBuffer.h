@@ -0,0 +1,133 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_RINGBUFFER_H
+#define SENTE_RINGBUFFER_H
+
+#include <atomic>
+#include <memory>
+#include <ciso646>
+
+namespace sente::utils {
+
+    /**
+     *
+     * a bounded queue that several threads may push to and pop from without locking
+     *
+     * each slot has a sequence number that says whether it is waiting for the push or the pop of the current lap
+     * around the buffer. a thread claims a slot by advancing the head (or tail) with a compare and swap, and then
+     * publishes the slot to the other side by bumping its sequence number.
+     *
+     */
+    template<typename Type>
+    class RingBuffer {
+    public:
+
+        /**
+         *
+         * @param capacity the number of items the buffer holds (rounded up to a power of two)
+         */
+        explicit RingBuffer(size_t capacity){
+
+            size_t size = 1;
+            while (size < capacity){
+                size *= 2;
+            }
+
+            mask = size - 1;
+            slots = std::make_unique<Slot[]>(size);
+
+            for (size_t i = 0; i < size; i++){
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        /**
+         *
+         * adds an item to the buffer if there is space for it
+         *
+         * @param item the item to add (only moved from if the push succeeds)
+         * @return whether the item was added
+         */
+        bool tryPush(Type& item){
+
+            size_t position = tail.load(std::memory_order_relaxed);
+
+            while (true){
+                Slot& slot = slots[position & mask];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                auto difference = std::ptrdiff_t(sequence) - std::ptrdiff_t(position);
+
+                if (difference == 0){
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)){
+                        slot.item = std::move(item);
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0){
+                    // the slot still holds the item from the last lap
+                    return false;
+                }
+                else {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         *
+         * takes the oldest item out of the buffer if there is one
+         *
+         * @param item the item to move the oldest item into
+         * @return whether an item was taken
+         */
+        bool tryPop(Type& item){
+
+            size_t position = head.load(std::memory_order_relaxed);
+
+            while (true){
+                Slot& slot = slots[position & mask];
+                size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                auto difference = std::ptrdiff_t(sequence) - std::ptrdiff_t(position + 1);
+
+                if (difference == 0){
+                    if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)){
+                        item = std::move(slot.item);
+                        slot.sequence.store(position + mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (difference < 0){
+                    // the slot hasn't been filled yet
+                    return false;
+                }
+                else {
+                    position = head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+
+        struct Slot {
+            std::atomic<size_t> sequence{0};
+            Type item;
+        };
+
+        size_t mask = 0;
+        std::unique_ptr<Slot[]> slots;
+
+        // the head and tail are kept on separate cache lines so that producers and consumers don't contend
+        alignas(64) std::atomic<size_t> head{0};
+        alignas(64) std::atomic<size_t> tail{0};
+
+    };
+
+}
+
+#endif //SENTE_RINGBUFFER_H
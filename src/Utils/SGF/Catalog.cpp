@@ -0,0 +1,558 @@
+//
+// Created on 10/18/26.
+//
+
+#include <cmath>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+#include <ciso646>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "SGF.h"
+#include "Corpus.h"
+#include "Catalog.h"
+#include "Collection.h"
+#include "../Parallel.h"
+#include "../Compression.h"
+#include "../MappedFile.h"
+#include "../LittleEndian.h"
+#include "../SenteExceptions.h"
+
+namespace sente::SGF {
+
+    // the catalog file starts with a magic string, a version number, the number of properties, the number of games
+    // and the number of files. the names of the files, the location of each game and the columns come next.
+    const char CATALOG_MAGIC[8] = {'S', 'E', 'N', 'T', 'E', 'C', 'A', 'T'};
+    const uint32_t CATALOG_VERSION = 1;
+    const size_t CATALOG_HEADER_SIZE = 32;
+
+    /**
+     *
+     * finds the column of a property in the catalog
+     *
+     */
+    size_t catalogColumn(SGFProperty property){
+        return std::find(CATALOG_PROPERTIES.begin(), CATALOG_PROPERTIES.end(), property) - CATALOG_PROPERTIES.begin();
+    }
+
+    /**
+     *
+     * converts an SGF date (ie. "2015-06-01") to a number that sorts in the same order (ie. 20150601)
+     *
+     * only the first date of a list of dates is used. parts of the date that are missing are replaced with the start
+     * or the end of the year or month, so "2015" is 20150000 or 20159999.
+     *
+     * @param date value of a DT property
+     * @param latest whether to fill in missing parts of the date with the latest possible value
+     * @return the date as YYYYMMDD (0 if the value doesn't start with a year)
+     */
+    uint32_t parseDate(std::string_view date, bool latest){
+
+        while (not date.empty() and std::isspace(date.front())){
+            date.remove_prefix(1);
+        }
+
+        auto readDigits = [&](size_t count, uint32_t& value){
+            if (date.size() < count){
+                return false;
+            }
+            value = 0;
+            for (size_t i = 0; i < count; i++){
+                if (not std::isdigit(date[i])){
+                    return false;
+                }
+                value = 10 * value + uint32_t(date[i] - '0');
+            }
+            date.remove_prefix(count);
+            return true;
+        };
+
+        uint32_t year, month = latest ? 99 : 0, day = latest ? 99 : 0;
+
+        if (not readDigits(4, year)){
+            return 0;
+        }
+
+        uint32_t part;
+        if (date.size() > 1 and date[0] == '-'){
+            date.remove_prefix(1);
+            if (readDigits(2, part)){
+                month = part;
+                if (date.size() > 1 and date[0] == '-'){
+                    date.remove_prefix(1);
+                    if (readDigits(2, part)){
+                        day = part;
+                    }
+                }
+            }
+        }
+
+        return 10000 * year + 100 * month + day;
+
+    }
+
+    /**
+     *
+     * the root properties and location of a game while the catalog is being built
+     *
+     */
+    struct CatalogRow {
+        uint32_t game;
+        uint64_t offset;
+        uint64_t length;
+        std::array<std::string, CATALOG_PROPERTIES.size()> values;
+    };
+
+    /**
+     *
+     * builds a catalog of the root properties of the games in a set of files and saves it
+     *
+     * the files are read in parallel and only the root node of each game is parsed. files that can't be read or split
+     * into games are left out of the catalog.
+     *
+     * @param fileNames paths to the SGF files (which may be gzip compressed collections)
+     * @param catalogFileName file to save the catalog to
+     * @param threads number of threads to read the files with (0 means one per hardware thread)
+     * @return the number of games in the catalog
+     */
+    size_t buildCatalog(const std::vector<std::string>& fileNames, const std::string& catalogFileName,
+                        unsigned threads){
+
+        std::vector<std::vector<CatalogRow>> rows(fileNames.size());
+
+        utils::parallelFor(fileNames.size(), threads, [&](size_t i){
+
+            std::string SGFText;
+            std::vector<std::pair<size_t, size_t>> games;
+
+            try {
+                SGFText = readSGFFile(fileNames[i]);
+                games = splitCollection(SGFText);
+            }
+            catch (const std::domain_error&){
+                // files that are missing or corrupt are left out of the catalog
+                return;
+            }
+
+            rows[i].resize(games.size());
+
+            for (size_t j = 0; j < games.size(); j++){
+
+                auto& row = rows[i][j];
+                row.game = uint32_t(j);
+                row.offset = games[j].first;
+                row.length = games[j].second;
+
+                // the catalog is only metadata, so unknown properties are silently ignored
+                std::vector<Diagnostic> diagnostics;
+                auto root = nodeFromText(rootNodeText(std::string_view(SGFText).substr(row.offset, row.length)), 0,
+                                         diagnostics, LoadOptions());
+
+                for (size_t k = 0; k < CATALOG_PROPERTIES.size(); k++){
+                    if (root.hasProperty(CATALOG_PROPERTIES[k])){
+                        row.values[k] = root.getProperty(CATALOG_PROPERTIES[k])[0];
+                    }
+                }
+            }
+        });
+
+        size_t gameCount = 0;
+        for (const auto& fileRows : rows){
+            gameCount += fileRows.size();
+        }
+
+        std::string contents(CATALOG_HEADER_SIZE, '\0');
+
+        auto append = [&](auto value){
+            char bytes[sizeof(value)];
+            utils::storeInteger(bytes, value);
+            contents.append(bytes, sizeof(bytes));
+        };
+        auto appendString = [&](const std::string& value){
+            append(uint32_t(value.size()));
+            contents.append(value);
+        };
+
+        std::memcpy(contents.data(), CATALOG_MAGIC, sizeof(CATALOG_MAGIC));
+        utils::storeInteger<uint32_t>(contents.data() + 8, CATALOG_VERSION);
+        utils::storeInteger<uint32_t>(contents.data() + 12, uint32_t(CATALOG_PROPERTIES.size()));
+        utils::storeInteger<uint64_t>(contents.data() + 16, gameCount);
+        utils::storeInteger<uint64_t>(contents.data() + 24, fileNames.size());
+
+        for (const auto& fileName : fileNames){
+            appendString(fileName);
+        }
+
+        // the location of each game
+        for (size_t i = 0; i < rows.size(); i++){
+            for (size_t j = 0; j < rows[i].size(); j++){
+                append(uint32_t(i));
+            }
+        }
+        for (const auto& fileRows : rows){
+            for (const auto& row : fileRows){
+                append(row.game);
+            }
+        }
+        for (const auto& fileRows : rows){
+            for (const auto& row : fileRows){
+                append(row.offset);
+            }
+        }
+        for (const auto& fileRows : rows){
+            for (const auto& row : fileRows){
+                append(row.length);
+            }
+        }
+
+        // each property is saved as a sorted dictionary of its values followed by the code of each game's value
+        for (size_t k = 0; k < CATALOG_PROPERTIES.size(); k++){
+
+            std::vector<std::string_view> dictionary;
+            for (const auto& fileRows : rows){
+                for (const auto& row : fileRows){
+                    dictionary.emplace_back(row.values[k]);
+                }
+            }
+            std::sort(dictionary.begin(), dictionary.end());
+            dictionary.erase(std::unique(dictionary.begin(), dictionary.end()), dictionary.end());
+
+            append(uint32_t(dictionary.size()));
+            for (const auto& value : dictionary){
+                appendString(std::string(value));
+            }
+
+            for (const auto& fileRows : rows){
+                for (const auto& row : fileRows){
+                    append(uint32_t(std::lower_bound(dictionary.begin(), dictionary.end(),
+                                                     std::string_view(row.values[k])) - dictionary.begin()));
+                }
+            }
+        }
+
+        utils::replaceFile(catalogFileName, contents);
+
+        return gameCount;
+
+    }
+
+    /**
+     *
+     * reads the values of a catalog file in order, checking that the file is long enough
+     *
+     */
+    class CatalogReader {
+    public:
+
+        CatalogReader(std::string_view contents, std::string fileName)
+            : remaining(contents), fileName(std::move(fileName)){}
+
+        template<typename Integer>
+        Integer read(){
+            if (remaining.size() < sizeof(Integer)){
+                throw truncated();
+            }
+            auto value = utils::loadInteger<Integer>(remaining.data());
+            remaining.remove_prefix(sizeof(Integer));
+            return value;
+        }
+
+        template<typename Integer>
+        void readColumn(std::vector<Integer>& column, size_t length){
+            if (remaining.size() / sizeof(Integer) < length){
+                throw truncated();
+            }
+            column.resize(length);
+            for (auto& value : column){
+                value = read<Integer>();
+            }
+        }
+
+        std::string readString(){
+            auto length = read<uint32_t>();
+            if (remaining.size() < length){
+                throw truncated();
+            }
+            std::string value(remaining.substr(0, length));
+            remaining.remove_prefix(length);
+            return value;
+        }
+
+        [[nodiscard]] utils::InvalidSGFException truncated() const {
+            return utils::InvalidSGFException("invalid catalog: \"" + fileName + "\" is truncated");
+        }
+
+    private:
+
+        std::string_view remaining;
+        std::string fileName;
+
+    };
+
+    Catalog::Catalog(const std::string& fileName){
+
+        utils::MappedFile file(fileName);
+
+        if (file.size() < CATALOG_HEADER_SIZE or
+            std::memcmp(file.data(), CATALOG_MAGIC, sizeof(CATALOG_MAGIC)) != 0){
+            throw utils::InvalidSGFException("invalid catalog: \"" + fileName + "\" is not a catalog");
+        }
+        if (utils::loadInteger<uint32_t>(file.data() + 8) != CATALOG_VERSION or
+            utils::loadInteger<uint32_t>(file.data() + 12) != CATALOG_PROPERTIES.size()){
+            throw utils::InvalidSGFException("invalid catalog: \"" + fileName + "\" was made by a different "
+                                             "version of sente");
+        }
+
+        auto gameCount = utils::loadInteger<uint64_t>(file.data() + 16);
+        auto fileCount = utils::loadInteger<uint64_t>(file.data() + 24);
+
+        CatalogReader reader(file.view().substr(CATALOG_HEADER_SIZE), fileName);
+
+        // every file name takes at least 4 bytes and every game at least 24, so this catches huge counts early
+        if (fileCount > file.size() / 4 or gameCount > file.size() / 24){
+            throw reader.truncated();
+        }
+
+        for (uint64_t i = 0; i < fileCount; i++){
+            fileNames.push_back(reader.readString());
+        }
+
+        reader.readColumn(files, gameCount);
+        reader.readColumn(games, gameCount);
+        reader.readColumn(offsets, gameCount);
+        reader.readColumn(lengths, gameCount);
+
+        for (auto fileIndex : files){
+            if (fileIndex >= fileCount){
+                throw utils::InvalidSGFException("invalid catalog: \"" + fileName + "\" is corrupt");
+            }
+        }
+
+        for (size_t k = 0; k < CATALOG_PROPERTIES.size(); k++){
+
+            auto dictionarySize = reader.read<uint32_t>();
+            if (dictionarySize > file.size() / 4){
+                throw reader.truncated();
+            }
+            for (uint32_t i = 0; i < dictionarySize; i++){
+                dictionaries[k].push_back(reader.readString());
+            }
+
+            reader.readColumn(codes[k], gameCount);
+
+            for (auto code : codes[k]){
+                if (code >= dictionarySize){
+                    throw utils::InvalidSGFException("invalid catalog: \"" + fileName + "\" is corrupt");
+                }
+            }
+        }
+
+        // the numeric columns are derived from the dictionaries, so each distinct value is only parsed once
+        auto deriveColumn = [&](SGFProperty property, auto& column, auto parse){
+            size_t k = catalogColumn(property);
+            std::vector<typename std::decay_t<decltype(column)>::value_type> parsed;
+            for (const auto& value : dictionaries[k]){
+                parsed.push_back(parse(value));
+            }
+            column.resize(gameCount);
+            for (size_t i = 0; i < gameCount; i++){
+                column[i] = parsed[codes[k][i]];
+            }
+        };
+
+        deriveColumn(DT, dates, [](const std::string& value){
+            return parseDate(value, false);
+        });
+        deriveColumn(KM, komis, [](const std::string& value){
+            char* end;
+            float komi = std::strtof(value.c_str(), &end);
+            return end == value.c_str() ? NAN : komi;
+        });
+        deriveColumn(HA, handicaps, [](const std::string& value){
+            return uint32_t(std::strtoul(value.c_str(), nullptr, 10));
+        });
+        deriveColumn(SZ, sizes, [](const std::string& value){
+            // rectangular boards ("19:13") are stored by their width
+            return value.empty() ? 19 : uint32_t(std::strtoul(value.c_str(), nullptr, 10));
+        });
+        deriveColumn(RE, winners, [](const std::string& value){
+            auto result = normalizeResult(value);
+            return result.size() >= 2 and result[1] == '+' ? result[0] : '\0';
+        });
+
+    }
+
+    /**
+     *
+     * the number of games in the catalog
+     *
+     */
+    size_t Catalog::size() const {
+        return files.size();
+    }
+
+    const std::string& Catalog::getFileName(size_t file) const {
+        return fileNames.at(file);
+    }
+
+    void Catalog::checkIndex(size_t index) const {
+        if (index >= size()){
+            throw std::out_of_range("game " + std::to_string(index) + " is out of range for a catalog of " +
+                                    std::to_string(size()) + " games");
+        }
+    }
+
+    /**
+     *
+     * finds where a game of the catalog is stored
+     *
+     * @param index id of the game in the catalog
+     */
+    CatalogLocation Catalog::getLocation(size_t index) const {
+        checkIndex(index);
+        return {files[index], games[index], offsets[index], lengths[index]};
+    }
+
+    /**
+     *
+     * gets the catalogued root properties of a game
+     *
+     * @param index id of the game in the catalog
+     * @return map from property names to values for each of the catalogued properties that the game has
+     */
+    std::unordered_map<std::string, std::string> Catalog::getProperties(size_t index) const {
+
+        checkIndex(index);
+
+        std::unordered_map<std::string, std::string> properties;
+
+        for (size_t k = 0; k < CATALOG_PROPERTIES.size(); k++){
+            const auto& value = dictionaries[k][codes[k][index]];
+            if (not value.empty()){
+                properties[toStr(CATALOG_PROPERTIES[k])] = value;
+            }
+        }
+
+        return properties;
+
+    }
+
+    /**
+     *
+     * finds the code of a value of a property
+     *
+     * @param column column of the property
+     * @param value value of the property
+     * @return the code of the value (if any game has the value)
+     */
+    std::optional<uint32_t> Catalog::findCode(size_t column, const std::string& value) const {
+
+        const auto& dictionary = dictionaries[column];
+        auto found = std::lower_bound(dictionary.begin(), dictionary.end(), value);
+
+        if (found == dictionary.end() or *found != value){
+            return std::nullopt;
+        }
+        return uint32_t(found - dictionary.begin());
+
+    }
+
+    /**
+     *
+     * finds the games that match a query
+     *
+     * each filter is applied to the whole of its column before moving on to the next one
+     *
+     * @param query filters that the games must match
+     * @return the ids of the matching games in the order they were catalogued
+     */
+    std::vector<uint32_t> Catalog::query(const CatalogQuery& query) const {
+
+        size_t count = size();
+        std::vector<uint8_t> mask(count, 1);
+
+        // codes that no game has
+        const uint32_t MISSING = UINT32_MAX;
+
+        auto filterColumn = [&](SGFProperty property, const std::string& value){
+            size_t k = catalogColumn(property);
+            uint32_t code = findCode(k, value).value_or(MISSING);
+            const auto& column = codes[k];
+            for (size_t i = 0; i < count; i++){
+                mask[i] &= column[i] == code;
+            }
+        };
+
+        if (query.player){
+            const auto& black = codes[catalogColumn(PB)];
+            const auto& white = codes[catalogColumn(PW)];
+            uint32_t blackCode = findCode(catalogColumn(PB), *query.player).value_or(MISSING);
+            uint32_t whiteCode = findCode(catalogColumn(PW), *query.player).value_or(MISSING);
+            for (size_t i = 0; i < count; i++){
+                mask[i] &= (black[i] == blackCode) | (white[i] == whiteCode);
+            }
+        }
+        if (query.black){
+            filterColumn(PB, *query.black);
+        }
+        if (query.white){
+            filterColumn(PW, *query.white);
+        }
+        if (query.event){
+            filterColumn(EV, *query.event);
+        }
+        if (query.rules){
+            filterColumn(RU, *query.rules);
+        }
+
+        if (query.winner){
+            char winner = *query.winner;
+            for (size_t i = 0; i < count; i++){
+                mask[i] &= winners[i] == winner;
+            }
+        }
+        if (query.dateFrom or query.dateTo){
+            // games without a date never match a date range
+            uint32_t first = query.dateFrom ? parseDate(*query.dateFrom, false) : 1;
+            uint32_t last = query.dateTo ? parseDate(*query.dateTo, true) : UINT32_MAX;
+            if (first == 0 or last == 0){
+                throw std::invalid_argument("dates must start with a year, ie. \"2015\" or \"2015-06-01\"");
+            }
+            for (size_t i = 0; i < count; i++){
+                mask[i] &= (dates[i] >= first) & (dates[i] <= last);
+            }
+        }
+        if (query.komi){
+            float komi = *query.komi;
+            for (size_t i = 0; i < count; i++){
+                mask[i] &= komis[i] == komi;
+            }
+        }
+        if (query.handicap){
+            uint32_t handicap = *query.handicap;
+            for (size_t i = 0; i < count; i++){
+                mask[i] &= handicaps[i] == handicap;
+            }
+        }
+        if (query.size){
+            uint32_t side = *query.size;
+            for (size_t i = 0; i < count; i++){
+                mask[i] &= sizes[i] == side;
+            }
+        }
+
+        std::vector<uint32_t> matches;
+        for (size_t i = 0; i < count; i++){
+            if (mask[i]){
+                matches.push_back(uint32_t(i));
+            }
+        }
+
+        return matches;
+
+    }
+
+}
@@ -0,0 +1,107 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_CATALOG_H
+#define SENTE_CATALOG_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+
+#include "SGFProperty.h"
+
+namespace sente::SGF {
+
+    // root properties that are stored in a catalog
+    const std::array<SGFProperty, 11> CATALOG_PROPERTIES = {PB, PW, BR, WR, DT, EV, RE, KM, RU, HA, SZ};
+
+    /**
+     *
+     * the location of a game in the files of a catalog
+     *
+     */
+    struct CatalogLocation {
+        size_t file = 0; // index of the file in the catalog
+        size_t game = 0; // index of the game in the file
+        uint64_t offset = 0; // offset of the game in the (decompressed) text of the file
+        uint64_t length = 0;
+    };
+
+    /**
+     *
+     * a filter on the games of a catalog, games must match every field that is set
+     *
+     */
+    struct CatalogQuery {
+        std::optional<std::string> player; // name of either player
+        std::optional<std::string> black;
+        std::optional<std::string> white;
+        std::optional<std::string> event;
+        std::optional<std::string> rules;
+        std::optional<char> winner; // 'B' or 'W'
+        std::optional<std::string> dateFrom; // dates are inclusive, ie. "2015" or "2015-06-01"
+        std::optional<std::string> dateTo;
+        std::optional<float> komi;
+        std::optional<unsigned> handicap;
+        std::optional<unsigned> size;
+    };
+
+    uint32_t parseDate(std::string_view date, bool latest);
+
+    size_t buildCatalog(const std::vector<std::string>& fileNames, const std::string& catalogFileName,
+                        unsigned threads);
+
+    /**
+     *
+     * the root properties of the games of a corpus, stored by column
+     *
+     * string properties are stored as a sorted dictionary of their values and a code for each game, dates, komi,
+     * handicaps, board sizes and winners are also stored as numbers. a query resolves each string it filters on to a
+     * code once and then scans flat columns, so thousands of games are filtered without parsing any SGF.
+     *
+     */
+    class Catalog {
+    public:
+
+        explicit Catalog(const std::string& fileName);
+
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] const std::string& getFileName(size_t file) const;
+
+        [[nodiscard]] CatalogLocation getLocation(size_t index) const;
+        [[nodiscard]] std::unordered_map<std::string, std::string> getProperties(size_t index) const;
+
+        [[nodiscard]] std::vector<uint32_t> query(const CatalogQuery& query) const;
+
+    private:
+
+        std::vector<std::string> fileNames;
+
+        std::vector<uint32_t> files;
+        std::vector<uint32_t> games;
+        std::vector<uint64_t> offsets;
+        std::vector<uint64_t> lengths;
+
+        // sorted values of each property and the index of each game's value (empty if the game doesn't have one)
+        std::array<std::vector<std::string>, CATALOG_PROPERTIES.size()> dictionaries;
+        std::array<std::vector<uint32_t>, CATALOG_PROPERTIES.size()> codes;
+
+        std::vector<uint32_t> dates; // YYYYMMDD with zeros for unknown parts (0 if the date is unknown)
+        std::vector<float> komis; // NaN if the komi is unknown
+        std::vector<uint32_t> handicaps;
+        std::vector<uint32_t> sizes;
+        std::vector<char> winners; // 'B', 'W' or '\0'
+
+        void checkIndex(size_t index) const;
+        [[nodiscard]] std::optional<uint32_t> findCode(size_t column, const std::string& value) const;
+
+    };
+
+}
+
+#endif //SENTE_CATALOG_H
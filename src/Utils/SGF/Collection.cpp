@@ -0,0 +1,362 @@
+//
+// Created on 10/18/26.
+//
+
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#include <zlib.h>
+
+#include "SGF.h"
+#include "Collection.h"
+#include "../Parallel.h"
+#include "../Compression.h"
+#include "../LittleEndian.h"
+#include "../SenteExceptions.h"
+
+namespace sente::SGF {
+
+    // the index file starts with a magic string and a version number so that stale formats are rebuilt
+    const char INDEX_MAGIC[8] = {'S', 'E', 'N', 'T', 'E', 'I', 'D', 'X'};
+    const uint32_t INDEX_VERSION = 2;
+
+    // the contents of a collection are checksummed in this many blocks of this size
+    const size_t CHECKSUM_BLOCKS = 256;
+    const size_t CHECKSUM_BLOCK_SIZE = 4096;
+
+    /**
+     *
+     * reads a little endian unsigned integer from the front of the index, checking that the index is long enough
+     *
+     */
+    template<typename Integer>
+    bool readInteger(std::string_view& input, Integer& value){
+        if (input.size() < sizeof(Integer)){
+            return false;
+        }
+        value = utils::loadInteger<Integer>(input.data());
+        input.remove_prefix(sizeof(Integer));
+        return true;
+    }
+
+    /**
+     *
+     * finds the text of the root node of a game, ie. "GM[1]PB[...]..." from "(;GM[1]PB[...]...;B[aa]...)"
+     *
+     * @param game text of the game
+     * @return the text of the root node (empty if the game has no nodes)
+     */
+    std::string_view rootNodeText(std::string_view game){
+
+        bool inBrackets = false;
+        size_t start = std::string_view::npos;
+
+        for (size_t i = 0; i < game.size(); i++){
+            switch (game[i]){
+                case '[':
+                    inBrackets = true;
+                    break;
+                case ']':
+                    inBrackets = false;
+                    break;
+                case '\\':
+                    i++;
+                    break;
+                case ';':
+                case '(':
+                case ')':
+                    if (not inBrackets){
+                        if (start != std::string_view::npos){
+                            // the next node or variation marks the end of the root
+                            return game.substr(start, i - start);
+                        }
+                        if (game[i] == ';'){
+                            start = i + 1;
+                        }
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (start == std::string_view::npos){
+            return {};
+        }
+        return game.substr(start);
+
+    }
+
+    bool CollectionFingerprint::operator==(const CollectionFingerprint& other) const {
+        return size == other.size and modified == other.modified and checksum == other.checksum;
+    }
+
+    /**
+     *
+     * records the size, modification time and a checksum of a collection file
+     *
+     * small files are checksummed entirely. for larger files only evenly spaced blocks (including the first and the
+     * last) are, so that opening a very large collection with an index stays cheap. the modification time catches
+     * edits that miss every block.
+     *
+     * @param file the collection file
+     * @return the fingerprint of the file
+     */
+    CollectionFingerprint fingerprintCollection(const utils::MappedFile& file){
+
+        CollectionFingerprint fingerprint;
+        fingerprint.size = file.size();
+        fingerprint.modified = file.modificationTime();
+
+        auto contents = file.view();
+        uLong checksum = crc32(0, nullptr, 0);
+
+        auto add = [&](size_t offset, size_t length){
+            checksum = crc32(checksum, reinterpret_cast<const Bytef*>(contents.data() + offset), uInt(length));
+        };
+
+        if (contents.size() <= CHECKSUM_BLOCKS * CHECKSUM_BLOCK_SIZE){
+            add(0, contents.size());
+        }
+        else {
+            for (size_t i = 0; i < CHECKSUM_BLOCKS; i++){
+                add((contents.size() - CHECKSUM_BLOCK_SIZE) / (CHECKSUM_BLOCKS - 1) * i, CHECKSUM_BLOCK_SIZE);
+            }
+        }
+
+        fingerprint.checksum = uint32_t(checksum);
+        return fingerprint;
+
+    }
+
+    /**
+     *
+     * finds every game in a collection and reads the indexed properties from their root nodes
+     *
+     * only the root node of each game is parsed
+     *
+     * @param SGFText text of the collection
+     * @param threads number of threads to read the root nodes with (0 means one per hardware thread)
+     * @return entries for each game in the order they appear in the collection
+     */
+    std::vector<CollectionEntry> buildIndex(std::string_view SGFText, unsigned threads){
+
+        auto offsets = splitCollection(SGFText);
+        std::vector<CollectionEntry> entries(offsets.size());
+
+        utils::parallelFor(offsets.size(), threads, [&](size_t i){
+
+            auto& entry = entries[i];
+            entry.offset = offsets[i].first;
+            entry.length = offsets[i].second;
+
+            // the index is only metadata, so unknown properties are silently ignored
+            std::vector<Diagnostic> diagnostics;
+            auto root = nodeFromText(rootNodeText(SGFText.substr(entry.offset, entry.length)), 0,
+                                     diagnostics, LoadOptions());
+
+            for (size_t j = 0; j < INDEXED_PROPERTIES.size(); j++){
+                if (root.hasProperty(INDEXED_PROPERTIES[j])){
+                    entry.properties[j] = root.getProperty(INDEXED_PROPERTIES[j])[0];
+                }
+            }
+        });
+
+        return entries;
+
+    }
+
+    /**
+     *
+     * saves a collection index
+     *
+     * the index is saved with utils::replaceFile, so a crash or a reader opening the collection at the same time
+     * never sees a half written index
+     *
+     * @param indexFileName file to write the index to
+     * @param entries entries of the index
+     * @param fingerprint fingerprint of the collection file, used to detect stale indices
+     */
+    void writeIndex(const std::string& indexFileName, const std::vector<CollectionEntry>& entries,
+                    const CollectionFingerprint& fingerprint){
+
+        std::string contents;
+
+        auto append = [&](auto value){
+            char bytes[sizeof(value)];
+            utils::storeInteger(bytes, value);
+            contents.append(bytes, sizeof(value));
+        };
+
+        contents.append(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        append(INDEX_VERSION);
+        append(uint64_t(fingerprint.size));
+        append(uint64_t(fingerprint.modified));
+        append(fingerprint.checksum);
+        append(uint64_t(entries.size()));
+
+        for (const auto& entry : entries){
+            append(entry.offset);
+            append(entry.length);
+            for (const auto& value : entry.properties){
+                append(uint32_t(value.size()));
+                contents += value;
+            }
+        }
+
+        utils::replaceFile(indexFileName, contents);
+
+    }
+
+    /**
+     *
+     * loads a collection index
+     *
+     * @param indexFileName file to read the index from
+     * @param entries vector to fill with the entries of the index
+     * @param fingerprint fingerprint of the collection file
+     * @return whether the index could be read (false if it does not exist, is corrupt or belongs to a different or
+     *         modified file)
+     */
+    bool readIndex(const std::string& indexFileName, std::vector<CollectionEntry>& entries,
+                   const CollectionFingerprint& fingerprint){
+
+        std::ifstream input(indexFileName, std::ios::binary);
+
+        if (not input.good()){
+            return false;
+        }
+
+        std::string contents((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+        std::string_view remaining = contents;
+
+        uint32_t version;
+        uint64_t count, modified;
+        CollectionFingerprint saved;
+
+        if (remaining.size() < sizeof(INDEX_MAGIC) or
+            std::memcmp(remaining.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0){
+            return false;
+        }
+        remaining.remove_prefix(sizeof(INDEX_MAGIC));
+
+        if (not readInteger(remaining, version) or version != INDEX_VERSION or
+            not readInteger(remaining, saved.size) or not readInteger(remaining, modified) or
+            not readInteger(remaining, saved.checksum) or not readInteger(remaining, count)){
+            return false;
+        }
+
+        saved.modified = int64_t(modified);
+
+        if (not (saved == fingerprint)){
+            return false;
+        }
+
+        std::vector<CollectionEntry> loaded;
+        loaded.reserve(std::min<uint64_t>(count, remaining.size()));
+
+        for (uint64_t i = 0; i < count; i++){
+
+            CollectionEntry entry;
+
+            if (not readInteger(remaining, entry.offset) or not readInteger(remaining, entry.length) or
+                entry.offset > fingerprint.size or entry.length > fingerprint.size - entry.offset){
+                return false;
+            }
+
+            for (auto& value : entry.properties){
+                uint32_t length;
+                if (not readInteger(remaining, length) or remaining.size() < length){
+                    return false;
+                }
+                value = remaining.substr(0, length);
+                remaining.remove_prefix(length);
+            }
+
+            loaded.push_back(std::move(entry));
+        }
+
+        entries = std::move(loaded);
+        return true;
+
+    }
+
+    Collection::Collection(const std::string& fileName, const std::string& indexFileName, unsigned threads)
+        : file(fileName){
+
+        std::string indexName = indexFileName.empty() ? fileName + ".index" : indexFileName;
+
+        auto fingerprint = fingerprintCollection(file);
+
+        if (not readIndex(indexName, entries, fingerprint)){
+
+            entries = buildIndex(file.view(), threads);
+
+            try {
+                writeIndex(indexName, entries, fingerprint);
+            }
+            catch (const utils::FileWriteException&){
+                // the index can't be saved (ie. a read only directory), keep using the one in memory
+            }
+        }
+
+    }
+
+    size_t Collection::size() const {
+        return entries.size();
+    }
+
+    const CollectionEntry& Collection::getEntry(size_t index) const {
+        if (index >= entries.size()){
+            throw std::out_of_range("game " + std::to_string(index) + " is out of range for a collection of " +
+                                    std::to_string(entries.size()) + " games");
+        }
+        return entries[index];
+    }
+
+    /**
+     *
+     * parses a single game from the collection
+     *
+     * @param index index of the game in the collection
+     * @return the game
+     */
+    GoGame Collection::getGame(size_t index, bool disableWarnings, bool ignoreIllegalProperties,
+                                             bool fixFileFormat) const {
+
+        const auto& entry = getEntry(index);
+
+        LoadOptions options;
+        options.ignoreIllegalProperties = ignoreIllegalProperties;
+        options.fixFileFormat = fixFileFormat;
+
+        // only the pages of the file that contain this game are read
+        return GoGame(loadSGF(file.view().substr(entry.offset, entry.length), disableWarnings, options));
+
+    }
+
+    /**
+     *
+     * gets the indexed root properties of a game without parsing it
+     *
+     * @param index index of the game in the collection
+     * @return map from property names to values for each of the indexed properties that the game has
+     */
+    std::unordered_map<std::string, std::string> Collection::getProperties(size_t index) const {
+
+        const auto& entry = getEntry(index);
+
+        std::unordered_map<std::string, std::string> properties;
+
+        for (size_t i = 0; i < INDEXED_PROPERTIES.size(); i++){
+            if (not entry.properties[i].empty()){
+                properties[toStr(INDEXED_PROPERTIES[i])] = entry.properties[i];
+            }
+        }
+
+        return properties;
+
+    }
+
+}
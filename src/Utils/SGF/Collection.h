@@ -0,0 +1,88 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_COLLECTION_H
+#define SENTE_COLLECTION_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "SGFProperty.h"
+#include "../MappedFile.h"
+#include "../../Game/GoGame.h"
+
+namespace sente::SGF {
+
+    // root properties that are stored in the index of a collection
+    const std::array<SGFProperty, 5> INDEXED_PROPERTIES = {PB, PW, DT, RE, SZ};
+
+    /**
+     *
+     * location and basic metadata of one game in a collection file
+     *
+     */
+    struct CollectionEntry {
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        std::array<std::string, INDEXED_PROPERTIES.size()> properties; // values of INDEXED_PROPERTIES
+    };
+
+    /**
+     *
+     * what an index records about its collection file, so that the index of a file that has since changed isn't used
+     *
+     */
+    struct CollectionFingerprint {
+        uint64_t size = 0;
+        int64_t modified = 0;
+        uint32_t checksum = 0; // checksum of samples of the contents (see fingerprintCollection)
+
+        bool operator==(const CollectionFingerprint& other) const;
+    };
+
+    std::string_view rootNodeText(std::string_view game);
+
+    CollectionFingerprint fingerprintCollection(const utils::MappedFile& file);
+    std::vector<CollectionEntry> buildIndex(std::string_view SGFText, unsigned threads);
+
+    void writeIndex(const std::string& indexFileName, const std::vector<CollectionEntry>& entries,
+                    const CollectionFingerprint& fingerprint);
+    bool readIndex(const std::string& indexFileName, std::vector<CollectionEntry>& entries,
+                   const CollectionFingerprint& fingerprint);
+
+    /**
+     *
+     * random access to the games of a (potentially very large) SGF collection file
+     *
+     * the collection file is memory mapped and the offset of every game is kept in a sidecar index file, so loading a
+     * game only reads and parses that game. the index is built (and saved) the first time the collection is opened.
+     *
+     */
+    class Collection {
+    public:
+
+        Collection(const std::string& fileName, const std::string& indexFileName, unsigned threads);
+
+        [[nodiscard]] size_t size() const;
+
+        [[nodiscard]] GoGame getGame(size_t index, bool disableWarnings, bool ignoreIllegalProperties,
+                                     bool fixFileFormat) const;
+        [[nodiscard]] std::unordered_map<std::string, std::string> getProperties(size_t index) const;
+
+    private:
+
+        utils::MappedFile file;
+        std::vector<CollectionEntry> entries;
+
+        const CollectionEntry& getEntry(size_t index) const;
+
+    };
+
+}
+
+#endif //SENTE_COLLECTION_H
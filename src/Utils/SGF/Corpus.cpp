@@ -0,0 +1,548 @@
+//
+// Created on 10/18/26.
+//
+
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <ciso646>
+#include <algorithm>
+
+#include "SGF.h"
+#include "Corpus.h"
+#include "../Parallel.h"
+#include "../SenteExceptions.h"
+#include "../../Game/Zobrist.h"
+
+namespace sente::SGF {
+
+    /**
+     *
+     * adds the counts of another set of statistics to these ones
+     *
+     * @param other statistics to add
+     */
+    void CorpusStats::merge(const CorpusStats& other){
+
+        games += other.games;
+        invalidFiles += other.invalidFiles;
+
+        for (const auto& [size, count] : other.boardSizes){
+            boardSizes[size] += count;
+        }
+        for (const auto& [result, count] : other.results){
+            results[result] += count;
+        }
+        for (const auto& [moves, count] : other.moveCounts){
+            moveCounts[moves] += count;
+        }
+        for (const auto& [player, count] : other.players){
+            players[player] += count;
+        }
+        for (const auto& [property, count] : other.unknownProperties){
+            unknownProperties[property] += count;
+        }
+
+    }
+
+    std::string_view trim(std::string_view text){
+        while (not text.empty() and std::isspace(text.front())){
+            text.remove_prefix(1);
+        }
+        while (not text.empty() and std::isspace(text.back())){
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    /**
+     *
+     * groups the value of an RE property so that results can be counted
+     *
+     * the margin of victory is dropped ("B+3.5" becomes "B+") but the way the game was won is kept ("W+Resign" becomes
+     * "W+R"). values that aren't valid results are returned unchanged.
+     *
+     * @param result value of the RE property
+     * @return the normalized result (empty if the value is empty)
+     */
+    std::string normalizeResult(std::string_view result){
+
+        result = trim(result);
+
+        std::string upper(result);
+        for (char& character : upper){
+            character = char(std::toupper(static_cast<unsigned char>(character)));
+        }
+
+        if (upper == "0" or upper == "DRAW" or upper == "JIGO"){
+            return "Draw";
+        }
+        if (upper == "VOID"){
+            return "Void";
+        }
+
+        if (upper.size() >= 2 and (upper[0] == 'B' or upper[0] == 'W') and upper[1] == '+'){
+            std::string winner = upper.substr(0, 2);
+            if (upper.size() > 2 and (upper[2] == 'R' or upper[2] == 'T' or upper[2] == 'F')){
+                // resignation, time or forfeit
+                return winner + upper[2];
+            }
+            return winner;
+        }
+
+        return std::string(result);
+
+    }
+
+    /**
+     *
+     * checks if a game starts from a position with stones on the board (ie. a handicap game)
+     *
+     * the corpus tools replay games from the empty board with GoGame, which doesn't place setup stones and always has
+     * black move first, so they skip these games rather than recording the wrong positions
+     *
+     * @param root root node of the game
+     * @return whether the root adds any stones (AB or AW)
+     */
+    bool hasSetupStones(const SGFNode& root){
+        return not root.getAddedMoves().empty();
+    }
+
+    /**
+     *
+     * adds a single game to a set of statistics
+     *
+     * the game is tokenized in a single pass without building any nodes, only the values of the root properties that
+     * are counted are copied out of the text.
+     *
+     * @param game text of the game, ie. "(;GM[1]...)"
+     * @param stats statistics to add the game to
+     */
+    void scanGame(std::string_view game, CorpusStats& stats){
+
+        size_t previousSlice = 0;
+        std::string_view property;
+
+        unsigned nodes = 0;
+        unsigned moves = 0;
+        // the main line ends at the first closing parenthesis, everything after that is a side variation
+        bool mainLine = true;
+
+        std::string_view size, result, black, white;
+        bool hasSize = false;
+
+        for (size_t i = 0; i < game.size(); i++){
+            switch (game[i]){
+                case '[': {
+
+                    // a name is only given for the first value of a property, ie. "AB[aa][bb]"
+                    auto name = trim(game.substr(previousSlice, i - previousSlice));
+                    if (not name.empty()){
+                        property = name;
+                        if (not isProperty(std::string(property))){
+                            stats.unknownProperties[std::string(property)]++;
+                        }
+                    }
+
+                    size_t end = findValueEnd(game, i + 1);
+                    while (end + 1 < game.size() and game[end] == '\\'){
+                        end = findValueEnd(game, end + 2);
+                    }
+
+                    auto value = game.substr(i + 1, end - i - 1);
+
+                    if (mainLine and (property == "B" or property == "W")){
+                        moves++;
+                    }
+                    else if (nodes == 1){
+                        if (property == "SZ"){
+                            size = value;
+                            hasSize = true;
+                        }
+                        else if (property == "RE"){
+                            result = value;
+                        }
+                        else if (property == "PB"){
+                            black = trim(value);
+                        }
+                        else if (property == "PW"){
+                            white = trim(value);
+                        }
+                    }
+
+                    i = end;
+                    previousSlice = end + 1;
+                    break;
+                }
+                case ';':
+                    nodes++;
+                    previousSlice = i + 1;
+                    break;
+                case ')':
+                    mainLine = false;
+                    previousSlice = i + 1;
+                    break;
+                case '(':
+                    previousSlice = i + 1;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (nodes == 0){
+            return;
+        }
+
+        stats.games++;
+        stats.moveCounts[moves]++;
+
+        if (not hasSize){
+            stats.boardSizes[19]++;
+        }
+        else {
+            // rectangular boards ("19:13") are counted by their width
+            size = trim(size);
+            if (not size.empty() and std::isdigit(size.front())){
+                stats.boardSizes[unsigned(std::strtoul(std::string(size).c_str(), nullptr, 10))]++;
+            }
+        }
+
+        auto normalized = normalizeResult(result);
+        if (not normalized.empty()){
+            stats.results[normalized]++;
+        }
+
+        if (not black.empty()){
+            stats.players[std::string(black)]++;
+        }
+        if (not white.empty()){
+            stats.players[std::string(white)]++;
+        }
+
+    }
+
+    /**
+     *
+     * adds every game in an SGF file (or collection) to a set of statistics
+     *
+     * @param fileName path to the file (which may be gzip compressed)
+     * @param stats statistics to add the games to
+     */
+    void scanFile(const std::string& fileName, CorpusStats& stats){
+
+        std::string SGFText;
+        std::vector<std::pair<size_t, size_t>> games;
+
+        try {
+            SGFText = readSGFFile(fileName);
+            games = splitCollection(SGFText);
+        }
+        catch (const std::domain_error&){
+            // one missing or bad file (ie. a truncated gzip file) shouldn't stop a scan of a whole corpus
+            stats.invalidFiles++;
+            return;
+        }
+
+        for (const auto& [offset, length] : games){
+            scanGame(std::string_view(SGFText).substr(offset, length), stats);
+        }
+
+    }
+
+    /**
+     *
+     * collects summary statistics for a set of SGF files, scanning the files in parallel
+     *
+     * each thread counts into its own statistics, which are merged once every file has been scanned
+     *
+     * @param fileNames paths to the files
+     * @param threads number of threads to scan with (0 means one per hardware thread)
+     * @return the statistics of every game in the files
+     */
+    CorpusStats corpusStats(const std::vector<std::string>& fileNames, unsigned threads){
+
+        std::vector<CorpusStats> accumulators(utils::getThreadCount(threads, fileNames.size()));
+
+        utils::parallelForWorkers(fileNames.size(), threads, [&](unsigned worker, size_t i){
+            scanFile(fileNames[i], accumulators[worker]);
+        });
+
+        CorpusStats total;
+        for (const auto& accumulator : accumulators){
+            total.merge(accumulator);
+        }
+
+        return total;
+
+    }
+
+    /**
+     *
+     * the moves of the main line of a game, along with the stones that are set up on the root
+     *
+     */
+    struct MainLine {
+        unsigned side = 19;
+        std::vector<Move> setup;
+        std::vector<Move> moves;
+    };
+
+    /**
+     *
+     * loads the main line of a game
+     *
+     * @param SGFText text of the game
+     * @param options options to load the game with
+     * @return the main line of the game
+     */
+    MainLine loadMainLine(std::string_view SGFText, const LoadOptions& options){
+
+        std::vector<Diagnostic> diagnostics;
+        auto tree = loadSGF(SGFText, diagnostics, options);
+
+        MainLine line;
+
+        // added stones have their co-ordinates swapped compared to moves
+        for (const auto& stone : tree.getRoot().getAddedMoves()){
+            line.setup.emplace_back(stone.getY(), stone.getX(), stone.getStone());
+        }
+
+        GoGame game(std::move(tree));
+        line.side = game.getSide();
+        line.moves = game.getDefaultSequence();
+
+        // nodes without a move (ie. comments) don't change the game
+        line.moves.erase(std::remove_if(line.moves.begin(), line.moves.end(), [](const Move& move){
+            return move.getStone() == EMPTY;
+        }), line.moves.end());
+
+        return line;
+
+    }
+
+    /**
+     *
+     * writes a game in a form that is the same for every rotation or reflection of it
+     *
+     * the game is written under each of the 8 symmetries of the board (rotations and reflections) and the smallest of
+     * the results is kept. the setup stones are sorted (the order they are added in doesn't matter) and come before
+     * the moves. passes are written the same way under every symmetry.
+     *
+     * @param setup stones that are set up before the first move (ie. handicap stones)
+     * @param moves moves of the game
+     * @param side size of the board that the game is played on
+     * @return the codes of the setup stones and moves of the game
+     */
+    std::vector<uint32_t> canonicalSequence(const std::vector<Move>& setup, const std::vector<Move>& moves,
+                                            unsigned side){
+
+        std::vector<uint32_t> best;
+        std::vector<uint32_t> sequence;
+
+        for (unsigned symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++){
+
+            // games on different boards or with different numbers of setup stones never match
+            sequence = {side, uint32_t(setup.size())};
+
+            for (const auto& stone : setup){
+                sequence.push_back(transformMove(stone, symmetry, side).getCode());
+            }
+            std::sort(sequence.begin() + 2, sequence.end());
+
+            for (const auto& move : moves){
+                sequence.push_back(transformMove(move, symmetry, side).getCode());
+            }
+
+            if (symmetry == 0 or sequence < best){
+                best.swap(sequence);
+            }
+        }
+
+        return best;
+
+    }
+
+    /**
+     *
+     * hashes a game so that games that are the same up to a symmetry of the board hash the same
+     *
+     * @param setup stones that are set up before the first move (ie. handicap stones)
+     * @param moves moves of the game
+     * @param side size of the board that the game is played on
+     * @return the hash of the canonical sequence of the game
+     */
+    uint64_t canonicalSequenceHash(const std::vector<Move>& setup, const std::vector<Move>& moves, unsigned side){
+
+        uint64_t hash = 0;
+
+        for (auto code : canonicalSequence(setup, moves, side)){
+            hash = mixHash(hash ^ code);
+        }
+
+        return hash;
+
+    }
+
+    /**
+     *
+     * finds the games that appear more than once in a set of SGF files, including games that are rotated or reflected
+     *
+     * the files are loaded in parallel (only the main line of each game is parsed) and each game is reduced to the
+     * hash of its canonical sequence, so no games are kept in memory. games with the same hash are loaded again and
+     * compared move by move, so games are never reported as duplicates because their hashes collide. games that can't
+     * be loaded are skipped.
+     *
+     * @param fileNames paths to the files (which may be gzip compressed collections)
+     * @param threads number of threads to load with (0 means one per hardware thread)
+     * @param minMoves games with fewer moves than this in their main line are skipped
+     * @return groups of games with the same main line, each group is in the order the games appear in the files
+     */
+    std::vector<std::vector<GameReference>> findDuplicates(const std::vector<std::string>& fileNames,
+                                                           unsigned threads, unsigned minMoves){
+
+        LoadOptions options;
+        options.mainLineOnly = true;
+        options.properties = makePropertyFilter({SZ}, {});
+
+        // calls function(game, text) for each game of a file, files that are missing or corrupt have no games
+        auto forEachGame = [](const std::string& fileName, const auto& function){
+
+            std::string SGFText;
+            std::vector<std::pair<size_t, size_t>> games;
+
+            try {
+                SGFText = readSGFFile(fileName);
+                games = splitCollection(SGFText);
+            }
+            catch (const std::domain_error&){
+                return;
+            }
+
+            for (size_t j = 0; j < games.size(); j++){
+                function(j, std::string_view(SGFText).substr(games[j].first, games[j].second));
+            }
+        };
+
+        std::vector<std::vector<std::pair<uint64_t, GameReference>>> accumulators(
+                utils::getThreadCount(threads, fileNames.size()));
+
+        utils::parallelForWorkers(fileNames.size(), threads, [&](unsigned worker, size_t i){
+            forEachGame(fileNames[i], [&](size_t j, std::string_view SGFText){
+                try {
+                    auto line = loadMainLine(SGFText, options);
+
+                    if (not line.moves.empty() and line.moves.size() >= minMoves){
+                        accumulators[worker].emplace_back(canonicalSequenceHash(line.setup, line.moves, line.side),
+                                                          GameReference{i, j});
+                    }
+                }
+                catch (const std::logic_error&){
+                    // games that can't be loaded can't be compared
+                }
+            });
+        });
+
+        std::vector<std::pair<uint64_t, GameReference>> hashes;
+        for (auto& accumulator : accumulators){
+            hashes.insert(hashes.end(), accumulator.begin(), accumulator.end());
+        }
+
+        auto order = [](const GameReference& first, const GameReference& second){
+            return std::make_pair(first.file, first.game) < std::make_pair(second.file, second.game);
+        };
+
+        // sorting brings duplicates together without a hash table of every game
+        std::sort(hashes.begin(), hashes.end(), [&](const auto& first, const auto& second){
+            if (first.first != second.first){
+                return first.first < second.first;
+            }
+            return order(first.second, second.second);
+        });
+
+        std::vector<std::vector<GameReference>> candidates;
+
+        for (size_t start = 0, end; start < hashes.size(); start = end){
+            for (end = start + 1; end < hashes.size() and hashes[end].first == hashes[start].first; end++);
+
+            if (end - start > 1){
+                candidates.emplace_back();
+                for (size_t k = start; k < end; k++){
+                    candidates.back().push_back(hashes[k].second);
+                }
+            }
+        }
+
+        // only the games with a matching hash are loaded again, each file at most once
+        std::vector<std::vector<size_t>> wanted(fileNames.size());
+        for (const auto& candidate : candidates){
+            for (const auto& game : candidate){
+                wanted[game.file].push_back(game.game);
+            }
+        }
+
+        std::vector<std::map<size_t, std::vector<uint32_t>>> sequences(fileNames.size());
+
+        utils::parallelFor(fileNames.size(), threads, [&](size_t i){
+
+            if (wanted[i].empty()){
+                return;
+            }
+
+            std::sort(wanted[i].begin(), wanted[i].end());
+
+            forEachGame(fileNames[i], [&](size_t j, std::string_view SGFText){
+                if (std::binary_search(wanted[i].begin(), wanted[i].end(), j)){
+                    try {
+                        auto line = loadMainLine(SGFText, options);
+                        sequences[i][j] = canonicalSequence(line.setup, line.moves, line.side);
+                    }
+                    catch (const std::logic_error&){
+                        // the file changed since it was hashed
+                    }
+                }
+            });
+        });
+
+        std::vector<std::vector<GameReference>> clusters;
+
+        for (const auto& candidate : candidates){
+
+            // games whose hashes collide are split into groups of games that really are the same
+            std::vector<std::pair<const std::vector<uint32_t>*, std::vector<GameReference>>> groups;
+
+            for (const auto& game : candidate){
+
+                auto found = sequences[game.file].find(game.game);
+                if (found == sequences[game.file].end()){
+                    continue;
+                }
+
+                auto group = std::find_if(groups.begin(), groups.end(), [&](const auto& group){
+                    return *group.first == found->second;
+                });
+
+                if (group == groups.end()){
+                    groups.emplace_back(&found->second, std::vector<GameReference>{game});
+                }
+                else {
+                    group->second.push_back(game);
+                }
+            }
+
+            for (auto& [sequence, games] : groups){
+                if (games.size() > 1){
+                    clusters.push_back(std::move(games));
+                }
+            }
+        }
+
+        std::sort(clusters.begin(), clusters.end(), [&](const auto& first, const auto& second){
+            return order(first.front(), second.front());
+        });
+
+        return clusters;
+
+    }
+
+}
@@ -0,0 +1,63 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_CORPUS_H
+#define SENTE_CORPUS_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+#include "SGFNode.h"
+#include "../../Game/Move.h"
+
+namespace sente::SGF {
+
+    /**
+     *
+     * summary statistics of a collection of SGF files
+     *
+     */
+    struct CorpusStats {
+        uint64_t games = 0;
+        uint64_t invalidFiles = 0; // files that could not be read or split into games
+        std::map<unsigned, uint64_t> boardSizes;
+        std::unordered_map<std::string, uint64_t> results; // normalized RE values, ie. "B+R" or "W+"
+        std::map<unsigned, uint64_t> moveCounts; // number of moves in the main line of each game
+        std::unordered_map<std::string, uint64_t> players; // games played by each PB/PW name
+        std::unordered_map<std::string, uint64_t> unknownProperties;
+
+        void merge(const CorpusStats& other);
+    };
+
+    /**
+     *
+     * the location of a game in a set of files
+     *
+     */
+    struct GameReference {
+        size_t file = 0; // index of the file in the list of files
+        size_t game = 0; // index of the game in the file (for collections)
+    };
+
+    std::string normalizeResult(std::string_view result);
+    bool hasSetupStones(const SGFNode& root);
+
+    void scanGame(std::string_view game, CorpusStats& stats);
+    void scanFile(const std::string& fileName, CorpusStats& stats);
+
+    CorpusStats corpusStats(const std::vector<std::string>& fileNames, unsigned threads);
+
+    std::vector<uint32_t> canonicalSequence(const std::vector<Move>& setup, const std::vector<Move>& moves,
+                                            unsigned side);
+    uint64_t canonicalSequenceHash(const std::vector<Move>& setup, const std::vector<Move>& moves, unsigned side);
+    std::vector<std::vector<GameReference>> findDuplicates(const std::vector<std::string>& fileNames,
+                                                           unsigned threads, unsigned minMoves);
+
+}
+
+#endif //SENTE_CORPUS_H
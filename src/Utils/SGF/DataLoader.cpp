@@ -0,0 +1,358 @@
+//
+// Created on 10/18/26.
+//
+
+#include <cmath>
+#include <chrono>
+#include <numeric>
+#include <optional>
+#include <algorithm>
+
+#include "DataLoader.h"
+#include "SGF.h"
+#include "Corpus.h"
+#include "../Parallel.h"
+#include "../SenteExceptions.h"
+#include "../../Game/GoGame.h"
+
+namespace sente::SGF {
+
+    /**
+     *
+     * waits a little before trying the ring buffer again, spinning at first and then sleeping
+     *
+     * @param attempts number of times the buffer has been tried so far
+     */
+    void backOff(unsigned& attempts){
+        if (attempts++ < 64){
+            std::this_thread::yield();
+        }
+        else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    /**
+     *
+     * loads the games of a corpus and starts the worker threads
+     *
+     * @param fileNames paths to the SGF files (which may be gzip compressed collections)
+     * @param batchSize number of positions in each batch
+     * @param features features to include for each position
+     * @param side size of the board (games of other sizes are left out)
+     * @param threads number of threads to load the games and fill the batches with (0 means one per hardware thread)
+     * @param prefetch number of batches that are kept ready
+     * @param seed seed for the random number generators of the workers
+     */
+    DataLoader::DataLoader(const std::vector<std::string>& fileNames, size_t batchSize,
+                           std::vector<utils::feature> features, unsigned side, unsigned threads, size_t prefetch,
+                           uint64_t seed)
+        : batchSize(batchSize), features(std::move(features)), side(side), ready(std::max<size_t>(prefetch, 1)) {
+
+        if (batchSize == 0){
+            throw std::invalid_argument("batches must have at least 1 position");
+        }
+        if (prefetch == 0){
+            throw std::invalid_argument("at least 1 batch must be prefetched");
+        }
+        if (this->features.empty()){
+            throw std::invalid_argument("at least 1 feature must be included");
+        }
+        if (side != 9 and side != 13 and side != 19){
+            throw std::invalid_argument("board size must be 9, 13 or 19");
+        }
+
+        loadGames(fileNames, threads);
+
+        if (firstPositions.back() == 0){
+            throw std::invalid_argument("the files don't have any positions to sample");
+        }
+
+        unsigned workerCount = utils::getThreadCount(threads, SIZE_MAX);
+        workers.reserve(workerCount);
+
+        for (unsigned i = 0; i < workerCount; i++){
+            workers.emplace_back(&DataLoader::work, this, seed, i);
+        }
+
+    }
+
+    DataLoader::~DataLoader(){
+
+        stopped = true;
+
+        for (auto& worker : workers){
+            worker.join();
+        }
+
+    }
+
+    /**
+     *
+     * takes the next batch, waiting for a worker to finish one if none are ready
+     *
+     */
+    Batch DataLoader::next(){
+
+        Batch batch;
+        unsigned attempts = 0;
+
+        while (not ready.tryPop(batch)){
+            backOff(attempts);
+        }
+
+        return batch;
+
+    }
+
+    size_t DataLoader::getBatchSize() const {
+        return batchSize;
+    }
+
+    size_t DataLoader::getFeatureCount() const {
+        return features.size();
+    }
+
+    unsigned DataLoader::getSide() const {
+        return side;
+    }
+
+    size_t DataLoader::getGameCount() const {
+        return games.size();
+    }
+
+    uint64_t DataLoader::getPositionCount() const {
+        return firstPositions.back();
+    }
+
+    /**
+     *
+     * loads the moves of the main line of every game
+     *
+     * each game is replayed once so that the workers never have to deal with illegal moves, the moves after the
+     * first illegal move of a game are dropped
+     *
+     * @param fileNames paths to the SGF files
+     * @param threads number of threads to load the games with
+     */
+    void DataLoader::loadGames(const std::vector<std::string>& fileNames, unsigned threads){
+
+        LoadOptions options;
+        options.mainLineOnly = true;
+        options.properties = makePropertyFilter({RE}, {});
+
+        std::vector<std::vector<SampleGame>> fileGames(fileNames.size());
+
+        utils::parallelFor(fileNames.size(), threads, [&](size_t i){
+
+            std::string SGFText;
+            std::vector<std::pair<size_t, size_t>> texts;
+
+            try {
+                SGFText = readSGFFile(fileNames[i]);
+                texts = splitCollection(SGFText);
+            }
+            catch (const std::domain_error&){
+                // files that are missing or corrupt are left out
+                return;
+            }
+
+            for (const auto& [start, length] : texts){
+
+                SampleGame sample;
+
+                try {
+                    std::vector<Diagnostic> diagnostics;
+                    auto tree = loadSGF(std::string_view(SGFText).substr(start, length), diagnostics, options);
+
+                    if (hasSetupStones(tree.getRoot())){
+                        continue;
+                    }
+
+                    GoGame game(std::move(tree));
+
+                    if (game.getSide() != side){
+                        continue;
+                    }
+
+                    const auto& root = game.getMoveTree().getRoot();
+                    if (root.hasProperty(RE)){
+                        auto result = normalizeResult(root.getFirstValue(RE));
+                        if (result.size() >= 2 and result[1] == '+'){
+                            sample.blackValue = result[0] == 'B' ? 1 : -1;
+                        }
+                    }
+
+                    sample.rules = game.getRules();
+
+                    auto moves = game.getDefaultSequence();
+                    game.resetBoard();
+
+                    for (const auto& move : moves){
+                        if (move.getStone() == EMPTY){
+                            // nodes without a move (ie. comments) don't change the position
+                            continue;
+                        }
+                        if (not move.isPass() and not game.isLegal(move)){
+                            break;
+                        }
+                        game.playStone(move);
+                        sample.moves.push_back(move);
+                    }
+                }
+                catch (const std::logic_error&){
+                    // games that can't be loaded are left out
+                    continue;
+                }
+
+                if (not sample.moves.empty()){
+                    fileGames[i].push_back(std::move(sample));
+                }
+            }
+        });
+
+        // keep the games in the order of the files so that a seed always samples the same positions
+        firstPositions = {0};
+
+        for (auto& file : fileGames){
+            for (auto& sample : file){
+                firstPositions.push_back(firstPositions.back() + sample.moves.size());
+                games.push_back(std::move(sample));
+            }
+        }
+
+    }
+
+    /**
+     *
+     * fills batches and puts them in the ring buffer until the loader is destroyed
+     *
+     * the positions of a batch are replayed in order, so positions that come from the same game share a replay. they
+     * are written to the batch in a random order.
+     *
+     * @param seed seed shared by every worker
+     * @param worker index of the worker
+     */
+    void DataLoader::work(uint64_t seed, unsigned worker){
+
+        std::seed_seq sequence{seed, uint64_t(worker)};
+        std::mt19937_64 random(sequence);
+
+        std::uniform_int_distribution<uint64_t> positionDistribution(0, firstPositions.back() - 1);
+        std::uniform_int_distribution<unsigned> symmetryDistribution(0, 7);
+
+        std::vector<uint64_t> positions(batchSize);
+        std::vector<size_t> slots(batchSize);
+        std::vector<int8_t> planes(features.size() * side * side);
+
+        while (not stopped){
+
+            Batch batch;
+            batch.features.resize(batchSize * planes.size());
+            batch.moves.resize(batchSize);
+            batch.values.resize(batchSize);
+
+            for (auto& position : positions){
+                position = positionDistribution(random);
+            }
+            std::sort(positions.begin(), positions.end());
+
+            std::iota(slots.begin(), slots.end(), 0);
+            std::shuffle(slots.begin(), slots.end(), random);
+
+            std::optional<GoGame> game;
+            size_t gameIndex = games.size();
+            size_t played = 0;
+
+            for (size_t i = 0; i < batchSize and not stopped; i++){
+
+                size_t sampleIndex = std::upper_bound(firstPositions.begin(), firstPositions.end(), positions[i])
+                                     - firstPositions.begin() - 1;
+                size_t moveIndex = positions[i] - firstPositions[sampleIndex];
+
+                const auto& sample = games[sampleIndex];
+
+                if (sampleIndex != gameIndex){
+                    game.emplace(side, sample.rules, INFINITY);
+                    gameIndex = sampleIndex;
+                    played = 0;
+                }
+
+                while (played < moveIndex){
+                    game->playStone(sample.moves[played++]);
+                }
+
+                writeSample(*game, sample.moves[moveIndex], sample.blackValue, symmetryDistribution(random), batch,
+                            slots[i], planes);
+            }
+
+            unsigned attempts = 0;
+            while (not ready.tryPush(batch)){
+                if (stopped){
+                    return;
+                }
+                backOff(attempts);
+            }
+        }
+
+    }
+
+    /**
+     *
+     * writes a position into a batch with one of the symmetries of the board
+     *
+     * @param game game at the position
+     * @param move move that was played from the position
+     * @param blackValue 1 if black won the game, -1 if white won and 0 if the result is unknown
+     * @param symmetry the symmetry to apply (bit 0 flips the rows, bit 1 flips the columns and bit 2 swaps them)
+     * @param batch batch to write the position into
+     * @param index index of the position in the batch
+     * @param planes buffer to write the untransformed features into
+     */
+    void DataLoader::writeSample(const GoGame& game, const Move& move, float blackValue, unsigned symmetry,
+                                 Batch& batch, size_t index, std::vector<int8_t>& planes) const {
+
+        utils::fillFeaturePlanes(game, features, planes.data());
+
+        auto transform = [&](unsigned i, unsigned j){
+            if (symmetry & 4){
+                std::swap(i, j);
+            }
+            if (symmetry & 1){
+                i = side - 1 - i;
+            }
+            if (symmetry & 2){
+                j = side - 1 - j;
+            }
+            return std::make_pair(i, j);
+        };
+
+        int8_t* output = batch.features.data() + index * planes.size();
+
+        for (unsigned plane = 0; plane < features.size(); plane++){
+            for (unsigned i = 0; i < side; i++){
+                for (unsigned j = 0; j < side; j++){
+                    auto [x, y] = transform(i, j);
+                    output[(plane * side + x) * side + y] = planes[(plane * side + i) * side + j];
+                }
+            }
+        }
+
+        if (move.isPass()){
+            batch.moves[index] = int32_t(side * side);
+        }
+        else {
+            auto [x, y] = transform(move.getX(), move.getY());
+            batch.moves[index] = int32_t(x * side + y);
+        }
+
+        if (blackValue == 0){
+            batch.values[index] = 0;
+        }
+        else {
+            batch.values[index] = move.getStone() == BLACK ? blackValue : -blackValue;
+        }
+
+    }
+
+}
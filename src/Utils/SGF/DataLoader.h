@@ -0,0 +1,89 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_DATALOADER_H
+#define SENTE_DATALOADER_H
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "../Numpy.h"
+#include "../RingBuffer.h"
+#include "../../Game/GoGame.h"
+#include "../../Game/GoComponents.h"
+
+namespace sente::SGF {
+
+    /**
+     *
+     * a batch of sampled positions
+     *
+     */
+    struct Batch {
+        std::vector<int8_t> features; // batch x features x side x side
+        std::vector<int32_t> moves; // the move played from each position (x * side + y, side * side for a pass)
+        std::vector<float> values; // 1 if the player to move won the game, -1 if they lost and 0 if unknown
+    };
+
+    /**
+     *
+     * samples random positions from the main lines of a corpus of games and turns them into batches
+     *
+     * the moves of every game are loaded once, then worker threads pick positions uniformly at random, replay each
+     * game up to its position, apply one of the eight symmetries of the board and write the features into a batch.
+     * finished batches wait in a lock free ring buffer until they are taken, so the workers stay a few batches ahead.
+     * games that can't be loaded, games of other board sizes and games with handicap stones are left out.
+     *
+     */
+    class DataLoader {
+    public:
+
+        DataLoader(const std::vector<std::string>& fileNames, size_t batchSize, std::vector<utils::feature> features,
+                   unsigned side, unsigned threads, size_t prefetch, uint64_t seed);
+        ~DataLoader();
+
+        DataLoader(const DataLoader&) = delete;
+        DataLoader& operator=(const DataLoader&) = delete;
+
+        Batch next();
+
+        [[nodiscard]] size_t getBatchSize() const;
+        [[nodiscard]] size_t getFeatureCount() const;
+        [[nodiscard]] unsigned getSide() const;
+        [[nodiscard]] size_t getGameCount() const;
+        [[nodiscard]] uint64_t getPositionCount() const;
+
+    private:
+
+        struct SampleGame {
+            std::vector<Move> moves;
+            Rules rules = CHINESE;
+            float blackValue = 0; // 1 if black won, -1 if white won
+        };
+
+        size_t batchSize;
+        std::vector<utils::feature> features;
+        unsigned side;
+
+        std::vector<SampleGame> games;
+        std::vector<uint64_t> firstPositions; // index of the first position of each game (and the total at the end)
+
+        utils::RingBuffer<Batch> ready;
+        std::atomic<bool> stopped{false};
+        std::vector<std::thread> workers;
+
+        void loadGames(const std::vector<std::string>& fileNames, unsigned threads);
+        void work(uint64_t seed, unsigned worker);
+        void writeSample(const GoGame& game, const Move& move, float blackValue, unsigned symmetry, Batch& batch,
+                         size_t index, std::vector<int8_t>& planes) const;
+
+    };
+
+}
+
+#endif //SENTE_DATALOADER_H
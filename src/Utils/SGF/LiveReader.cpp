@@ -0,0 +1,168 @@
+//
+// Created on 10/18/26.
+//
+
+#include <fstream>
+
+#include "LiveReader.h"
+#include "../SenteExceptions.h"
+
+namespace sente::SGF {
+
+    // number of parsed bytes that are compared on each update to detect a rewritten file
+    const size_t ANCHOR_SIZE = 64;
+
+    LiveReader::LiveReader(std::string fileName, const LoadOptions& options)
+        : fileName(std::move(fileName)), options(options), game(19, CHINESE, determineKomi(CHINESE)) {
+        update();
+    }
+
+    /**
+     *
+     * reads the text that was added to the file since the last update and adds its nodes to the game
+     *
+     * the file is re-read from the start if it got shorter or if the end of the text that was already parsed changed
+     *
+     * @return the number of nodes that were added
+     */
+    unsigned LiveReader::update(){
+
+        std::ifstream file(fileName, std::ios::binary | std::ios::ate);
+        if (not file.good()){
+            throw utils::FileNotFoundException(fileName);
+        }
+
+        auto size = size_t(file.tellg());
+
+        if (size < offset){
+            reset();
+        }
+
+        // read the anchor again along with the new text
+        size_t start = offset - anchor.size();
+        std::string text(size - start, '\0');
+        file.seekg(std::streamoff(start));
+        file.read(text.data(), std::streamsize(text.size()));
+
+        if (text.compare(0, anchor.size(), anchor) != 0){
+            reset();
+            start = 0;
+            text.resize(size);
+            file.seekg(0);
+            file.read(text.data(), std::streamsize(text.size()));
+        }
+
+        std::string_view view(text);
+
+        // index in the text of the first byte that hasn't been consumed
+        size_t consumed = anchor.size();
+        unsigned added = 0;
+
+        auto addPendingNode = [&](size_t end){
+            if (inNode){
+                auto nodeText = view.substr(consumed, end - consumed);
+                if (nodeText.find_first_not_of(" \t\r\n") != std::string_view::npos){
+                    addNode(nodeText, start + consumed);
+                    added++;
+                }
+            }
+            inNode = false;
+        };
+
+        for (size_t i = consumed; i < view.size(); i++){
+
+            char character = view[i];
+
+            if (character == '['){
+                size_t end = findValueEnd(view, i + 1);
+                while (end < view.size() and view[end] == '\\'){
+                    end = end + 2 < view.size() ? findValueEnd(view, end + 2) : view.size();
+                }
+                if (end >= view.size()){
+                    // the value hasn't been written completely yet
+                    break;
+                }
+                i = end;
+            }
+            else if (character == ';'){
+                addPendingNode(i);
+                inNode = true;
+                consumed = i + 1;
+            }
+            else if (character == '('){
+                addPendingNode(i);
+                variations.push_back(current);
+                consumed = i + 1;
+            }
+            else if (character == ')'){
+                addPendingNode(i);
+                if (variations.size() <= 1){
+                    // leave the end of the game unconsumed in case more moves are written before it
+                    consumed = i;
+                    break;
+                }
+                current = variations.back();
+                variations.pop_back();
+                consumed = i + 1;
+            }
+        }
+
+        offset = start + consumed;
+        size_t anchorSize = std::min(ANCHOR_SIZE, consumed);
+        anchor = text.substr(consumed - anchorSize, anchorSize);
+
+        return added;
+
+    }
+
+    GoGame& LiveReader::getGame(){
+        return game;
+    }
+
+    size_t LiveReader::getOffset() const {
+        return offset;
+    }
+
+    /**
+     *
+     * forgets everything that was read so that the file is parsed again from the start
+     *
+     */
+    void LiveReader::reset(){
+        game = GoGame(19, CHINESE, determineKomi(CHINESE));
+        hasRoot = false;
+        offset = 0;
+        anchor.clear();
+        inNode = false;
+        current = utils::ROOT_NODE;
+        variations.clear();
+    }
+
+    /**
+     *
+     * parses a node and adds it below the current node
+     *
+     * @param text text of the node without the leading ';'
+     * @param nodeOffset offset of the text in the file
+     */
+    void LiveReader::addNode(std::string_view text, size_t nodeOffset){
+
+        // warnings are dropped, a file that is being written is often incomplete
+        std::vector<Diagnostic> diagnostics;
+        SGFNode node = nodeFromText(text, nodeOffset, diagnostics, options);
+
+        if (not hasRoot){
+            if (node.hasProperty(GM) and node.getFirstValue(GM) != "1"){
+                throw utils::InvalidSGFException("Game is not a Go Game (Sente only parses Go Games)");
+            }
+            game = GoGame(utils::Tree<SGFNode>(node));
+            hasRoot = true;
+            current = utils::ROOT_NODE;
+        }
+        else {
+            current = game.appendNode(current, node);
+        }
+
+    }
+
+}
@@ -0,0 +1,66 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_LIVEREADER_H
+#define SENTE_LIVEREADER_H
+
+#include <string>
+#include <vector>
+#include <string_view>
+
+#include "SGF.h"
+#include "../Tree.h"
+#include "../../Game/GoGame.h"
+
+namespace sente::SGF {
+
+    /**
+     *
+     * follows an SGF file that is being appended to (ie. a relay of a live game)
+     *
+     * the reader remembers how far into the file it has parsed, so each update only reads the bytes that were added
+     * since the last one and adds the new nodes to the same game. a node is added once the next node (or the end of a
+     * variation) has started, so the last node of a file that is still being written waits for the next update.
+     *
+     * the closing parenthesis of the game is never consumed, so relays that rewrite the end of the file each time a
+     * move is added are followed too. if anything before the end of the parsed text changes, the game is re-read.
+     *
+     */
+    class LiveReader {
+    public:
+
+        LiveReader(std::string fileName, const LoadOptions& options);
+
+        unsigned update();
+
+        GoGame& getGame();
+        [[nodiscard]] size_t getOffset() const;
+
+    private:
+
+        std::string fileName;
+        LoadOptions options;
+
+        GoGame game;
+        bool hasRoot = false;
+
+        // the text before offset has been parsed, the last few bytes of it are kept to detect files being rewritten
+        size_t offset = 0;
+        std::string anchor;
+
+        // whether the text at offset is the inside of a node (it follows a ';')
+        bool inNode = false;
+
+        // node that the next node is added below and the nodes that each open variation started from
+        utils::NodeID current = utils::ROOT_NODE;
+        std::vector<utils::NodeID> variations;
+
+        void reset();
+        void addNode(std::string_view text, size_t nodeOffset);
+
+    };
+
+}
+
+#endif //SENTE_LIVEREADER_H
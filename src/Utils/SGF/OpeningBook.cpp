@@ -0,0 +1,312 @@
+//
+// Created on 10/18/26.
+//
+
+#include <cstring>
+#include <ciso646>
+#include <algorithm>
+#include <unordered_map>
+
+#include "SGF.h"
+#include "Corpus.h"
+#include "OpeningBook.h"
+#include "../Parallel.h"
+#include "../Compression.h"
+#include "../LittleEndian.h"
+#include "../SenteExceptions.h"
+#include "../../Game/Zobrist.h"
+
+namespace sente::SGF {
+
+    // the book file starts with a magic string, a version number, the depth of the book and the number of entries
+    const char BOOK_MAGIC[8] = {'S', 'E', 'N', 'T', 'E', 'B', 'O', 'K'};
+    const uint32_t BOOK_VERSION = 1;
+    const size_t BOOK_HEADER_SIZE = 24;
+
+    // each entry is the hash of the position (8 bytes), the move (2 bytes, followed by 2 bytes of padding) and the
+    // count, wins and losses of the move (4 bytes each)
+    const size_t BOOK_ENTRY_SIZE = 24;
+
+    /**
+     *
+     * a move played from a position, with the move in the canonical orientation of the position
+     *
+     */
+    struct BookKey {
+        uint64_t hash;
+        uint16_t move;
+
+        bool operator==(const BookKey& other) const {
+            return hash == other.hash and move == other.move;
+        }
+    };
+
+    struct BookKeyHash {
+        size_t operator()(const BookKey& key) const noexcept {
+            return size_t(mixHash(key.hash ^ key.move));
+        }
+    };
+
+    struct BookStats {
+        uint32_t count = 0;
+        uint32_t wins = 0;
+        uint32_t losses = 0;
+    };
+
+    using BookCounts = std::unordered_map<BookKey, BookStats, BookKeyHash>;
+
+    /**
+     *
+     * adds the opening of a game to the counts of a book
+     *
+     * @param SGFText text of the game
+     * @param depth number of moves of the game to add
+     * @param options options to load the game with
+     * @param counts counts to add the moves to
+     */
+    void addToBook(std::string_view SGFText, unsigned depth, const LoadOptions& options, BookCounts& counts){
+
+        std::vector<Diagnostic> diagnostics;
+        auto tree = loadSGF(SGFText, diagnostics, options);
+
+        const auto& root = tree.getRoot();
+
+        if (hasSetupStones(root)){
+            return;
+        }
+
+        Stone winner = EMPTY;
+        if (root.hasProperty(RE)){
+            auto result = normalizeResult(root.getProperty(RE)[0]);
+            if (result.rfind("B+", 0) == 0){
+                winner = BLACK;
+            }
+            else if (result.rfind("W+", 0) == 0){
+                winner = WHITE;
+            }
+        }
+
+        GoGame game(std::move(tree));
+        unsigned side = game.getSide();
+
+        auto moves = game.getDefaultSequence();
+        game.resetBoard();
+
+        unsigned played = 0;
+
+        for (const auto& move : moves){
+
+            if (played == depth){
+                break;
+            }
+            if (move.getStone() == EMPTY){
+                // nodes without a move (ie. comments) don't change the position
+                continue;
+            }
+
+            auto hashes = symmetricHashes(game);
+            uint64_t key = hashes[canonicalSymmetry(hashes)];
+
+            try {
+                game.playStone(move);
+            }
+            catch (const utils::IllegalMoveException&){
+                // the rest of the game can't be replayed
+                break;
+            }
+
+            // in symmetric positions (ie. the empty board) equivalent moves are stored as a single move
+            uint16_t code = UINT16_MAX;
+            for (unsigned symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++){
+                if (hashes[symmetry] == key){
+                    code = std::min(code, transformMove(move, symmetry, side).getCode());
+                }
+            }
+
+            auto& stats = counts[{key, code}];
+            stats.count++;
+            if (winner == move.getStone()){
+                stats.wins++;
+            }
+            else if (winner != EMPTY){
+                stats.losses++;
+            }
+
+            played++;
+        }
+
+    }
+
+    /**
+     *
+     * builds an opening book from the openings of a set of games and saves it
+     *
+     * the games are replayed in parallel, each thread counts the moves into its own table and the tables are merged
+     * once every game has been replayed. games that can't be loaded are skipped.
+     *
+     * @param fileNames paths to the SGF files (which may be gzip compressed collections)
+     * @param bookFileName file to save the book to
+     * @param depth number of moves from the start of each game to add to the book
+     * @param threads number of threads to replay the games with (0 means one per hardware thread)
+     * @return the number of entries in the book
+     */
+    size_t buildOpeningBook(const std::vector<std::string>& fileNames, const std::string& bookFileName,
+                            unsigned depth, unsigned threads){
+
+        LoadOptions options;
+        options.mainLineOnly = true;
+        options.properties = makePropertyFilter({RE}, {});
+
+        std::vector<BookCounts> accumulators(utils::getThreadCount(threads, fileNames.size()));
+
+        utils::parallelForWorkers(fileNames.size(), threads, [&](unsigned worker, size_t i){
+
+            std::string SGFText;
+            std::vector<std::pair<size_t, size_t>> games;
+
+            try {
+                SGFText = readSGFFile(fileNames[i]);
+                games = splitCollection(SGFText);
+            }
+            catch (const std::domain_error&){
+                // files that are missing or corrupt are left out of the book
+                return;
+            }
+
+            for (const auto& [offset, length] : games){
+                try {
+                    addToBook(std::string_view(SGFText).substr(offset, length), depth, options,
+                              accumulators[worker]);
+                }
+                catch (const std::logic_error&){
+                    // games that can't be loaded are left out of the book
+                }
+            }
+        });
+
+        auto& counts = accumulators.front();
+        for (size_t i = 1; i < accumulators.size(); i++){
+            for (const auto& [key, stats] : accumulators[i]){
+                auto& total = counts[key];
+                total.count += stats.count;
+                total.wins += stats.wins;
+                total.losses += stats.losses;
+            }
+            accumulators[i] = BookCounts();
+        }
+
+        std::vector<std::pair<BookKey, BookStats>> entries(counts.begin(), counts.end());
+        std::sort(entries.begin(), entries.end(), [](const auto& first, const auto& second){
+            return std::make_pair(first.first.hash, first.first.move) <
+                   std::make_pair(second.first.hash, second.first.move);
+        });
+
+        std::string contents(BOOK_HEADER_SIZE + entries.size() * BOOK_ENTRY_SIZE, '\0');
+
+        std::memcpy(contents.data(), BOOK_MAGIC, sizeof(BOOK_MAGIC));
+        utils::storeInteger<uint32_t>(contents.data() + 8, BOOK_VERSION);
+        utils::storeInteger<uint32_t>(contents.data() + 12, depth);
+        utils::storeInteger<uint64_t>(contents.data() + 16, entries.size());
+
+        char* entry = contents.data() + BOOK_HEADER_SIZE;
+        for (const auto& [key, stats] : entries){
+            utils::storeInteger<uint64_t>(entry, key.hash);
+            utils::storeInteger<uint16_t>(entry + 8, key.move);
+            utils::storeInteger<uint32_t>(entry + 12, stats.count);
+            utils::storeInteger<uint32_t>(entry + 16, stats.wins);
+            utils::storeInteger<uint32_t>(entry + 20, stats.losses);
+            entry += BOOK_ENTRY_SIZE;
+        }
+
+        utils::replaceFile(bookFileName, contents);
+
+        return entries.size();
+
+    }
+
+    OpeningBook::OpeningBook(const std::string& fileName) : file(fileName){
+
+        if (file.size() < BOOK_HEADER_SIZE or std::memcmp(file.data(), BOOK_MAGIC, sizeof(BOOK_MAGIC)) != 0){
+            throw utils::InvalidSGFException("invalid opening book: \"" + fileName + "\" is not an opening book");
+        }
+        if (utils::loadInteger<uint32_t>(file.data() + 8) != BOOK_VERSION){
+            throw utils::InvalidSGFException("invalid opening book: \"" + fileName + "\" was made by a different "
+                                             "version of sente");
+        }
+
+        depth = utils::loadInteger<uint32_t>(file.data() + 12);
+        entryCount = utils::loadInteger<uint64_t>(file.data() + 16);
+
+        if ((file.size() - BOOK_HEADER_SIZE) / BOOK_ENTRY_SIZE != entryCount or
+            (file.size() - BOOK_HEADER_SIZE) % BOOK_ENTRY_SIZE != 0){
+            throw utils::InvalidSGFException("invalid opening book: \"" + fileName + "\" is truncated");
+        }
+
+    }
+
+    size_t OpeningBook::size() const {
+        return entryCount;
+    }
+
+    unsigned OpeningBook::getDepth() const {
+        return depth;
+    }
+
+    const char* OpeningBook::getEntry(size_t index) const {
+        return file.data() + BOOK_HEADER_SIZE + index * BOOK_ENTRY_SIZE;
+    }
+
+    /**
+     *
+     * finds the moves that were played from the current position of a game
+     *
+     * rotations and reflections of the position share their moves, the moves are returned in the orientation of the
+     * game
+     *
+     * @param game game to look up the position of
+     * @return the statistics of each move played from the position, the most played moves first
+     */
+    std::vector<BookMove> OpeningBook::lookup(const GoGame& game) const {
+
+        auto hashes = symmetricHashes(game);
+        unsigned symmetry = canonicalSymmetry(hashes);
+        uint64_t key = hashes[symmetry];
+
+        // binary search for the first entry of the position
+        size_t low = 0;
+        size_t high = entryCount;
+        while (low < high){
+            size_t middle = low + (high - low) / 2;
+            if (utils::loadInteger<uint64_t>(getEntry(middle)) < key){
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+
+        unsigned inverse = inverseSymmetry(symmetry);
+        std::vector<BookMove> moves;
+
+        for (size_t i = low; i < entryCount and utils::loadInteger<uint64_t>(getEntry(i)) == key; i++){
+
+            const char* entry = getEntry(i);
+
+            auto code = utils::loadInteger<uint16_t>(entry + 8);
+            Move move((code >> 5) & 31, code & 31, Stone(code >> 10));
+
+            moves.push_back({transformMove(move, inverse, game.getSide()),
+                             utils::loadInteger<uint32_t>(entry + 12),
+                             utils::loadInteger<uint32_t>(entry + 16),
+                             utils::loadInteger<uint32_t>(entry + 20)});
+        }
+
+        std::stable_sort(moves.begin(), moves.end(), [](const BookMove& first, const BookMove& second){
+            return first.count > second.count;
+        });
+
+        return moves;
+
+    }
+
+}
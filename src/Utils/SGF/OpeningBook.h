@@ -0,0 +1,64 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_OPENINGBOOK_H
+#define SENTE_OPENINGBOOK_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "../MappedFile.h"
+#include "../../Game/GoGame.h"
+
+namespace sente::SGF {
+
+    /**
+     *
+     * statistics of a move played from a position of an opening book
+     *
+     */
+    struct BookMove {
+        Move move;
+        uint32_t count = 0; // number of games the move was played in
+        uint32_t wins = 0; // games won by the player who played the move
+        uint32_t losses = 0;
+    };
+
+    size_t buildOpeningBook(const std::vector<std::string>& fileNames, const std::string& bookFileName,
+                            unsigned depth, unsigned threads);
+
+    /**
+     *
+     * read only access to an opening book file
+     *
+     * the book is a table of (position, move) entries sorted by the hash of the position, which is memory mapped
+     * rather than read so that opening a book is instant and looking up a position only touches a few pages.
+     * positions are keyed by their symmetry canonical zobrist hash, so rotated and reflected positions share their
+     * statistics.
+     *
+     */
+    class OpeningBook {
+    public:
+
+        explicit OpeningBook(const std::string& fileName);
+
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] unsigned getDepth() const;
+
+        [[nodiscard]] std::vector<BookMove> lookup(const GoGame& game) const;
+
+    private:
+
+        utils::MappedFile file;
+        size_t entryCount = 0;
+        unsigned depth = 0;
+
+        [[nodiscard]] const char* getEntry(size_t index) const;
+
+    };
+
+}
+
+#endif //SENTE_OPENINGBOOK_H
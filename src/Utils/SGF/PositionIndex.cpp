@@ -0,0 +1,368 @@
+//
+// Created on 10/18/26.
+//
+
+#include <cstring>
+#include <ciso646>
+#include <algorithm>
+#include <unordered_set>
+
+#include "SGF.h"
+#include "Corpus.h"
+#include "PositionIndex.h"
+#include "../Parallel.h"
+#include "../Compression.h"
+#include "../LittleEndian.h"
+#include "../SenteExceptions.h"
+#include "../../Game/Zobrist.h"
+
+namespace sente::SGF {
+
+    // the index file starts with a magic string, a version number, the number of files, the number of entries and
+    // the offset of the first entry. the names of the files come next, followed by the entries.
+    const char POSITION_INDEX_MAGIC[8] = {'S', 'E', 'N', 'T', 'E', 'P', 'O', 'S'};
+    const uint32_t POSITION_INDEX_VERSION = 1;
+    const size_t POSITION_INDEX_HEADER_SIZE = 40;
+
+    // each entry is the hash of the position (8 bytes), the id of the game (4 bytes) and the move number (4 bytes)
+    const size_t POSITION_ENTRY_SIZE = 16;
+
+    /**
+     *
+     * an entry of the index before the ids of the games are known
+     *
+     */
+    struct PositionEntry {
+        uint64_t hash;
+        uint32_t file;
+        uint32_t game;
+        uint32_t move;
+    };
+
+    /**
+     *
+     * replays the main line of a game and records the hash of every position and every corner in it
+     *
+     * each hash is only recorded the first time it occurs in the game, so a corner that doesn't change while the
+     * players are busy elsewhere only has one entry
+     *
+     * @param SGFText text of the game
+     * @param options options to load the game with
+     * @param file index of the file that the game is in
+     * @param gameIndex index of the game in its file
+     * @param entries vector to append the entries to
+     */
+    void indexGame(std::string_view SGFText, const LoadOptions& options, uint32_t file, uint32_t gameIndex,
+                   std::vector<PositionEntry>& entries){
+
+        std::vector<Diagnostic> diagnostics;
+        auto tree = loadSGF(SGFText, diagnostics, options);
+
+        if (hasSetupStones(tree.getRoot())){
+            return;
+        }
+
+        GoGame game(std::move(tree));
+
+        auto moves = game.getDefaultSequence();
+        game.resetBoard();
+
+        PositionHasher hasher(game.getSide());
+        std::unordered_set<uint64_t> seen;
+
+        uint32_t moveNumber = 0;
+
+        auto record = [&](uint64_t hash){
+            if (seen.insert(hash).second){
+                entries.push_back({hash, file, gameIndex, moveNumber});
+            }
+        };
+
+        for (const auto& move : moves){
+
+            if (move.getStone() == EMPTY){
+                // nodes without a move (ie. comments) don't change the position
+                continue;
+            }
+
+            try {
+                game.playStone(move);
+            }
+            catch (const utils::IllegalMoveException&){
+                // the rest of the game can't be replayed
+                break;
+            }
+
+            moveNumber++;
+            hasher.update(game);
+
+            if (hasher.isEmpty()){
+                continue;
+            }
+
+            record(hasher.getBoardHash());
+            for (unsigned corner = 0; corner < 4; corner++){
+                if (not hasher.isCornerEmpty(corner)){
+                    record(hasher.getCornerHash(corner));
+                }
+            }
+        }
+
+    }
+
+    /**
+     *
+     * builds a position index of a set of SGF files and saves it
+     *
+     * the games are replayed in parallel, each thread collects the entries of its games and the entries are sorted
+     * by hash once every game has been replayed. games that can't be loaded (and games with handicap stones) are
+     * left out of the index.
+     *
+     * @param fileNames paths to the SGF files (which may be gzip compressed collections)
+     * @param indexFileName file to save the index to
+     * @param threads number of threads to replay the games with (0 means one per hardware thread)
+     * @return the number of games in the files
+     */
+    size_t buildPositionIndex(const std::vector<std::string>& fileNames, const std::string& indexFileName,
+                              unsigned threads){
+
+        LoadOptions options;
+        options.mainLineOnly = true;
+        options.properties = makePropertyFilter({}, {});
+
+        std::vector<std::vector<PositionEntry>> accumulators(utils::getThreadCount(threads, fileNames.size()));
+        std::vector<uint32_t> gameCounts(fileNames.size());
+
+        utils::parallelForWorkers(fileNames.size(), threads, [&](unsigned worker, size_t i){
+
+            std::string SGFText;
+            std::vector<std::pair<size_t, size_t>> games;
+
+            try {
+                SGFText = readSGFFile(fileNames[i]);
+                games = splitCollection(SGFText);
+            }
+            catch (const std::domain_error&){
+                // files that are missing or corrupt are left out of the index
+                return;
+            }
+
+            gameCounts[i] = uint32_t(games.size());
+
+            for (size_t j = 0; j < games.size(); j++){
+                try {
+                    indexGame(std::string_view(SGFText).substr(games[j].first, games[j].second), options,
+                              uint32_t(i), uint32_t(j), accumulators[worker]);
+                }
+                catch (const std::logic_error&){
+                    // games that can't be loaded are left out of the index
+                }
+            }
+        });
+
+        // games are numbered in the order of the files
+        std::vector<uint64_t> firstGames(fileNames.size() + 1, 0);
+        for (size_t i = 0; i < fileNames.size(); i++){
+            firstGames[i + 1] = firstGames[i] + gameCounts[i];
+        }
+
+        std::vector<std::pair<uint64_t, std::pair<uint32_t, uint32_t>>> entries;
+        for (auto& accumulator : accumulators){
+            for (const auto& entry : accumulator){
+                entries.push_back({entry.hash, {uint32_t(firstGames[entry.file] + entry.game), entry.move}});
+            }
+            accumulator = std::vector<PositionEntry>();
+        }
+
+        std::sort(entries.begin(), entries.end());
+
+        // the names of the files
+        size_t namesSize = 8;
+        for (const auto& fileName : fileNames){
+            namesSize += 12 + fileName.size();
+        }
+        // the entries are aligned to 8 bytes
+        size_t entriesOffset = (POSITION_INDEX_HEADER_SIZE + namesSize + 7) / 8 * 8;
+
+        std::string contents(entriesOffset + entries.size() * POSITION_ENTRY_SIZE, '\0');
+
+        std::memcpy(contents.data(), POSITION_INDEX_MAGIC, sizeof(POSITION_INDEX_MAGIC));
+        utils::storeInteger<uint32_t>(contents.data() + 8, POSITION_INDEX_VERSION);
+        utils::storeInteger<uint64_t>(contents.data() + 16, fileNames.size());
+        utils::storeInteger<uint64_t>(contents.data() + 24, entries.size());
+        utils::storeInteger<uint64_t>(contents.data() + 32, entriesOffset);
+
+        char* position = contents.data() + POSITION_INDEX_HEADER_SIZE;
+        for (size_t i = 0; i < fileNames.size(); i++){
+            utils::storeInteger<uint64_t>(position, firstGames[i]);
+            utils::storeInteger<uint32_t>(position + 8, uint32_t(fileNames[i].size()));
+            std::memcpy(position + 12, fileNames[i].data(), fileNames[i].size());
+            position += 12 + fileNames[i].size();
+        }
+        utils::storeInteger<uint64_t>(position, firstGames.back());
+
+        char* entry = contents.data() + entriesOffset;
+        for (const auto& [hash, match] : entries){
+            utils::storeInteger<uint64_t>(entry, hash);
+            utils::storeInteger<uint32_t>(entry + 8, match.first);
+            utils::storeInteger<uint32_t>(entry + 12, match.second);
+            entry += POSITION_ENTRY_SIZE;
+        }
+
+        utils::replaceFile(indexFileName, contents);
+
+        return firstGames.back();
+
+    }
+
+    PositionIndex::PositionIndex(const std::string& fileName) : file(fileName){
+
+        auto invalid = [&](const std::string& reason){
+            return utils::InvalidSGFException("invalid position index: \"" + fileName + "\" " + reason);
+        };
+
+        if (file.size() < POSITION_INDEX_HEADER_SIZE or
+            std::memcmp(file.data(), POSITION_INDEX_MAGIC, sizeof(POSITION_INDEX_MAGIC)) != 0){
+            throw invalid("is not a position index");
+        }
+        if (utils::loadInteger<uint32_t>(file.data() + 8) != POSITION_INDEX_VERSION){
+            throw invalid("was made by a different version of sente");
+        }
+
+        auto fileCount = utils::loadInteger<uint64_t>(file.data() + 16);
+        entryCount = utils::loadInteger<uint64_t>(file.data() + 24);
+        entriesOffset = utils::loadInteger<uint64_t>(file.data() + 32);
+
+        if (entriesOffset > file.size() or (file.size() - entriesOffset) / POSITION_ENTRY_SIZE != entryCount or
+            (file.size() - entriesOffset) % POSITION_ENTRY_SIZE != 0){
+            throw invalid("is truncated");
+        }
+
+        size_t position = POSITION_INDEX_HEADER_SIZE;
+
+        for (uint64_t i = 0; i < fileCount; i++){
+            if (entriesOffset - std::min(position, entriesOffset) < 12){
+                throw invalid("is corrupt");
+            }
+            firstGames.push_back(utils::loadInteger<uint64_t>(file.data() + position));
+            auto length = utils::loadInteger<uint32_t>(file.data() + position + 8);
+            if (entriesOffset - position - 12 < length){
+                throw invalid("is corrupt");
+            }
+            fileNames.emplace_back(file.data() + position + 12, length);
+            position += 12 + length;
+        }
+
+        if (entriesOffset - std::min(position, entriesOffset) < 8){
+            throw invalid("is corrupt");
+        }
+        firstGames.push_back(utils::loadInteger<uint64_t>(file.data() + position));
+
+    }
+
+    /**
+     *
+     * the number of games in the files of the index
+     *
+     */
+    size_t PositionIndex::size() const {
+        return firstGames.back();
+    }
+
+    const std::string& PositionIndex::getFileName(size_t index) const {
+        return fileNames.at(index);
+    }
+
+    /**
+     *
+     * finds the games that contain a position hash
+     *
+     * @param key hash of the position
+     * @param matches vector to append the id of each game and the move the position occurred at to
+     */
+    void PositionIndex::findMatches(uint64_t key, std::vector<std::pair<uint32_t, uint32_t>>& matches) const {
+
+        auto getEntry = [&](size_t index){
+            return file.data() + entriesOffset + index * POSITION_ENTRY_SIZE;
+        };
+
+        // binary search for the first entry of the position
+        size_t low = 0;
+        size_t high = entryCount;
+        while (low < high){
+            size_t middle = low + (high - low) / 2;
+            if (utils::loadInteger<uint64_t>(getEntry(middle)) < key){
+                low = middle + 1;
+            }
+            else {
+                high = middle;
+            }
+        }
+
+        for (size_t i = low; i < entryCount and utils::loadInteger<uint64_t>(getEntry(i)) == key; i++){
+            matches.emplace_back(utils::loadInteger<uint32_t>(getEntry(i) + 8),
+                                 utils::loadInteger<uint32_t>(getEntry(i) + 12));
+        }
+
+    }
+
+    /**
+     *
+     * finds every game in which the current position of a game occurred
+     *
+     * positions match in any orientation and with the colors of the stones swapped. when searching by corners, each
+     * corner of the position that has stones in it is searched for in every corner of the indexed games.
+     *
+     * @param game game whose position is searched for
+     * @param corners whether to search for the corners of the position rather than the whole board
+     * @return the matching games (in the order they were indexed) with the first move they matched at
+     */
+    std::vector<PositionMatch> PositionIndex::search(const GoGame& game, bool corners) const {
+
+        PositionHasher hasher(game.getSide());
+        hasher.update(game);
+
+        std::vector<std::pair<uint32_t, uint32_t>> matches;
+
+        if (hasher.isEmpty()){
+            // the empty board isn't indexed
+            return {};
+        }
+
+        if (corners){
+            std::vector<uint64_t> keys;
+            for (unsigned corner = 0; corner < 4; corner++){
+                if (not hasher.isCornerEmpty(corner)){
+                    keys.push_back(hasher.getCornerHash(corner));
+                }
+            }
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+            for (uint64_t key : keys){
+                findMatches(key, matches);
+            }
+        }
+        else {
+            findMatches(hasher.getBoardHash(), matches);
+        }
+
+        // only keep the first match in each game
+        std::sort(matches.begin(), matches.end());
+        matches.erase(std::unique(matches.begin(), matches.end(), [](const auto& first, const auto& second){
+            return first.first == second.first;
+        }), matches.end());
+
+        std::vector<PositionMatch> results;
+        results.reserve(matches.size());
+
+        for (const auto& [id, move] : matches){
+            size_t fileIndex = std::upper_bound(firstGames.begin(), firstGames.end(), id) - firstGames.begin() - 1;
+            results.push_back({fileIndex, id - firstGames[fileIndex], move});
+        }
+
+        return results;
+
+    }
+
+}
@@ -0,0 +1,66 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_POSITIONINDEX_H
+#define SENTE_POSITIONINDEX_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "../MappedFile.h"
+#include "../../Game/GoGame.h"
+
+namespace sente::SGF {
+
+    /**
+     *
+     * a game in which a position occurred
+     *
+     */
+    struct PositionMatch {
+        size_t file = 0; // index of the file in the index
+        size_t game = 0; // index of the game in the file
+        unsigned move = 0; // number of moves that had been played when the position first occurred
+    };
+
+    size_t buildPositionIndex(const std::vector<std::string>& fileNames, const std::string& indexFileName,
+                              unsigned threads);
+
+    /**
+     *
+     * read only access to a position index file
+     *
+     * the index maps the hash of every position (and of every corner of every position) in the main line of each
+     * game of a corpus to the games it occurred in. the entries are sorted by hash and memory mapped, so a search is a
+     * binary search that only touches a few pages of the file.
+     *
+     */
+    class PositionIndex {
+    public:
+
+        explicit PositionIndex(const std::string& fileName);
+
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] const std::string& getFileName(size_t file) const;
+
+        [[nodiscard]] std::vector<PositionMatch> search(const GoGame& game, bool corners) const;
+
+    private:
+
+        utils::MappedFile file;
+
+        std::vector<std::string> fileNames;
+        std::vector<uint64_t> firstGames; // id of the first game of each file (followed by the total number of games)
+
+        size_t entriesOffset = 0;
+        size_t entryCount = 0;
+
+        void findMatches(uint64_t key, std::vector<std::pair<uint32_t, uint32_t>>& matches) const;
+
+    };
+
+}
+
+#endif //SENTE_POSITIONINDEX_H
@@ -0,0 +1,224 @@
+//
+// Created on 10/18/26.
+//
+
+#include "Positions.h"
+#include "Corpus.h"
+#include "../SenteExceptions.h"
+
+namespace sente::SGF {
+
+    PositionStream::PositionStream(std::vector<std::string> fileNames, std::vector<utils::feature> features,
+                                   unsigned every, size_t capacity)
+        : fileNames(std::move(fileNames)), features(std::move(features)), every(every), capacity(capacity) {
+
+        if (this->every == 0){
+            throw std::invalid_argument("positions must be taken every 1 or more moves");
+        }
+        if (this->capacity == 0){
+            throw std::invalid_argument("the queue must hold at least 1 position");
+        }
+
+        worker = std::thread(&PositionStream::run, this);
+
+    }
+
+    PositionStream::~PositionStream(){
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopped = true;
+        }
+        notFull.notify_all();
+
+        worker.join();
+
+    }
+
+    /**
+     *
+     * takes the next position out of the queue, waiting for the thread to replay it if needed
+     *
+     * if the thread stopped because of an error (ie. a file that doesn't exist), the error is raised once every
+     * position before it has been taken
+     *
+     * @return the next position, or nothing if every game has been replayed
+     */
+    std::optional<Position> PositionStream::next(){
+
+        std::unique_lock<std::mutex> guard(lock);
+
+        notEmpty.wait(guard, [&]{
+            return not queue.empty() or finished;
+        });
+
+        if (queue.empty()){
+            if (error){
+                // only raise the error once
+                auto thrown = error;
+                error = nullptr;
+                std::rethrow_exception(thrown);
+            }
+            return std::nullopt;
+        }
+
+        Position position = std::move(queue.front());
+        queue.pop_front();
+
+        guard.unlock();
+        notFull.notify_one();
+
+        return position;
+
+    }
+
+    /**
+     *
+     * replays every game of every file
+     *
+     */
+    void PositionStream::run(){
+
+        LoadOptions options;
+        options.mainLineOnly = true;
+        options.properties = makePropertyFilter({RE}, {});
+
+        try {
+            for (const auto& fileName : fileNames){
+
+                auto SGFText = readSGFFile(fileName);
+
+                std::vector<std::pair<size_t, size_t>> games;
+
+                try {
+                    games = splitCollection(SGFText);
+                }
+                catch (const utils::InvalidSGFException&){
+                    continue;
+                }
+
+                for (const auto& [start, length] : games){
+                    if (not replayGame(std::string_view(SGFText).substr(start, length), options)){
+                        return;
+                    }
+                }
+            }
+        }
+        catch (...){
+            std::lock_guard<std::mutex> guard(lock);
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            finished = true;
+        }
+        notEmpty.notify_all();
+
+    }
+
+    /**
+     *
+     * replays the main line of a game and puts every position that a move is played from in the queue
+     *
+     * @param SGFText text of the game
+     * @param options options to load the game with
+     * @return false if the stream was stopped while the game was being replayed
+     */
+    bool PositionStream::replayGame(std::string_view SGFText, const LoadOptions& options){
+
+        std::optional<GoGame> game;
+
+        try {
+            std::vector<Diagnostic> diagnostics;
+            auto tree = loadSGF(SGFText, diagnostics, options);
+
+            if (hasSetupStones(tree.getRoot())){
+                return true;
+            }
+
+            game.emplace(std::move(tree));
+        }
+        catch (const std::logic_error&){
+            // games that can't be loaded are skipped
+            return true;
+        }
+
+        auto moves = game->getDefaultSequence();
+        game->resetBoard();
+
+        const auto& root = game->getMoveTree().getRoot();
+        std::string result = root.hasProperty(RE) ? root.getFirstValue(RE) : "";
+
+        unsigned moveNumber = 0;
+
+        for (const auto& move : moves){
+
+            if (move.getStone() == EMPTY){
+                // nodes without a move (ie. comments) don't change the position
+                continue;
+            }
+
+            if (not move.isPass() and not game->isLegal(move)){
+                // the rest of the game can't be replayed
+                break;
+            }
+
+            if (moveNumber % every == 0){
+
+                Position position;
+                position.moveNumber = moveNumber;
+                position.side = game->getSide();
+                position.nextMove = move;
+                position.result = result;
+
+                if (features.empty()){
+                    position.board = game->copyBoard();
+                }
+                else {
+                    position.features.resize(position.side * position.side * features.size());
+                    utils::fillFeatures(*game, features, position.features.data());
+                }
+
+                if (not push(std::move(position))){
+                    return false;
+                }
+            }
+
+            game->playStone(move);
+            moveNumber++;
+        }
+
+        return true;
+
+    }
+
+    /**
+     *
+     * puts a position in the queue, waiting for there to be space for it
+     *
+     * @param position position to add
+     * @return false if the stream was stopped before there was space
+     */
+    bool PositionStream::push(Position position){
+
+        std::unique_lock<std::mutex> guard(lock);
+
+        notFull.wait(guard, [&]{
+            return queue.size() < capacity or stopped;
+        });
+
+        if (stopped){
+            return false;
+        }
+
+        queue.push_back(std::move(position));
+
+        guard.unlock();
+        notEmpty.notify_one();
+
+        return true;
+
+    }
+
+}
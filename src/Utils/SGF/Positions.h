@@ -0,0 +1,85 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_POSITIONS_H
+#define SENTE_POSITIONS_H
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <optional>
+#include <exception>
+#include <condition_variable>
+
+#include "SGF.h"
+#include "../Numpy.h"
+#include "../../Game/GoGame.h"
+
+namespace sente::SGF {
+
+    /**
+     *
+     * a position from the main line of a game and the move that was played from it
+     *
+     */
+    struct Position {
+        unsigned moveNumber = 0; // number of moves played before the position
+        std::unique_ptr<_board> board; // a copy of the board (if no features were requested)
+        std::vector<int8_t> features; // side x side x features array (if features were requested)
+        unsigned side = 19;
+        Move nextMove = Move::nullMove;
+        std::string result; // the RE property of the game
+    };
+
+    /**
+     *
+     * replays the main lines of a set of SGF files on a background thread
+     *
+     * the positions are put in a bounded queue, so the thread stays a little ahead of whoever is taking positions
+     * out of it without holding every position in memory. games that can't be loaded (and games with handicap stones)
+     * are skipped.
+     *
+     */
+    class PositionStream {
+    public:
+
+        PositionStream(std::vector<std::string> fileNames, std::vector<utils::feature> features, unsigned every,
+                       size_t capacity);
+        ~PositionStream();
+
+        PositionStream(const PositionStream&) = delete;
+        PositionStream& operator=(const PositionStream&) = delete;
+
+        std::optional<Position> next();
+
+    private:
+
+        std::vector<std::string> fileNames;
+        std::vector<utils::feature> features;
+        unsigned every;
+        size_t capacity;
+
+        std::mutex lock;
+        std::condition_variable notFull;
+        std::condition_variable notEmpty;
+        std::deque<Position> queue;
+
+        bool finished = false; // the thread has replayed every game
+        bool stopped = false; // the stream is being destroyed
+        std::exception_ptr error;
+
+        std::thread worker;
+
+        void run();
+        bool replayGame(std::string_view SGFText, const LoadOptions& options);
+        bool push(Position position);
+
+    };
+
+}
+
+#endif //SENTE_POSITIONS_H
@@ -3,12 +3,19 @@
 //
 
 #include <stack>
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <optional>
 #include <regex>
 #include <sstream>
 
 #include <pybind11/pybind11.h>
 
 #include "SGF.h"
+#include "../Parallel.h"
+#include "../Compression.h"
+#include "../ZipArchive.h"
 #include "../SenteExceptions.h"
 
 namespace py = pybind11;
@@ -32,79 +39,87 @@ std::string strip(const std::string &input)
 
 namespace sente::SGF {
 
-    void warn(const std::string& message){
-        // acquire the GIL
-        py::gil_scoped_acquire acquire;
-        PyErr_WarnEx(PyExc_Warning, message.c_str(), 1);
-    }
-
-    void addChildrenSGFProperties(utils::Tree<SGFNode>& SGFTree, std::unordered_set<SGFProperty>& properties){
-
-        // add all the properties from this Node
-        std::unordered_map<SGFProperty, std::vector<std::string>> currentProperties = SGFTree.get().getProperties();
+    /**
+     *
+     * fills in the line and column of diagnostics from their offsets
+     *
+     * @param SGFText text that the offsets refer to
+     * @param diagnostics diagnostics to locate
+     * @param first index of the first diagnostic to locate
+     */
+    void locateDiagnostics(std::string_view SGFText, std::vector<Diagnostic>& diagnostics, size_t first){
+
+        if (first >= diagnostics.size()){
+            return;
+        }
 
-        for (const auto& item : currentProperties){
-            properties.insert(item.first);
+        // find the start of every line once rather than re-scanning the text for every diagnostic
+        std::vector<size_t> lineStarts{0};
+        for (size_t i = 0; i < SGFText.size(); i++){
+            if (SGFText[i] == '\n'){
+                lineStarts.push_back(i + 1);
+            }
         }
 
-        // add all the children's properties
-        for (auto& child : SGFTree.getChildren()){
-            SGFTree.stepTo(child);
-            addChildrenSGFProperties(SGFTree, properties);
-            SGFTree.stepUp();
+        for (auto diagnostic = diagnostics.begin() + first; diagnostic != diagnostics.end(); diagnostic++){
+            auto line = std::upper_bound(lineStarts.begin(), lineStarts.end(), diagnostic->offset) - 1;
+            diagnostic->line = unsigned(line - lineStarts.begin()) + 1;
+            diagnostic->column = unsigned(diagnostic->offset - *line) + 1;
         }
 
     }
 
-    std::unordered_set<SGFProperty> getTreeProperties(utils::Tree<SGFNode>& SGFTree){
-
-        // record the current sequence of moves to get to this node
-        std::vector<SGFNode> currentSequence = SGFTree.getSequence();
-
-        // go to the root of the tree
-        SGFTree.advanceToRoot();
-
-        // add all the properties from all the nodes
-        std::unordered_set<SGFProperty> properties;
-        addChildrenSGFProperties(SGFTree, properties);
-
-        // return to the original position
-        SGFTree.advanceToRoot();
-        for (auto& item : currentSequence){
-            SGFTree.stepTo(item);
+    /**
+     *
+     * issues a python warning for each diagnostic
+     *
+     * the GIL is acquired once for the whole batch, so this should be called after parsing rather than during it
+     *
+     * @param diagnostics diagnostics to warn about
+     * @param source name of the file (or game) the diagnostics came from, if any
+     */
+    void emitWarnings(const std::vector<Diagnostic>& diagnostics, const std::string& source){
+
+        if (diagnostics.empty()){
+            return;
         }
 
-        return properties;
+        // acquire the GIL
+        py::gil_scoped_acquire acquire;
 
+        for (const auto& diagnostic : diagnostics){
+            std::string message = diagnostic.message + " (" + (source.empty() ? "" : source + ", ") +
+                                  "line " + std::to_string(diagnostic.line) +
+                                  ", column " + std::to_string(diagnostic.column) + ")";
+            PyErr_WarnEx(PyExc_Warning, message.c_str(), 1);
+        }
     }
 
-    void handleUnknownSGFProperty(const std::string& unknownProperty, bool disableWarnings,
-                                                                      bool ignoreIllegalProperties) {
+    void handleUnknownSGFProperty(const std::string& unknownProperty, size_t offset,
+                                  std::vector<Diagnostic>& diagnostics, bool ignoreIllegalProperties) {
 
         std::string message = "Unknown SGF Property: \"" + unknownProperty + "\"";
 
         if (ignoreIllegalProperties) {
-            // if we are ignoring illegal properties, warn the user (unless
-            if (not disableWarnings){
-                warn(message);
-            }
+            // if we are ignoring illegal properties, record a warning for the user
+            diagnostics.push_back({message, offset});
         }
         else {
             throw utils::InvalidSGFException(message);
         }
     }
 
-    void handleUnsupportedProperty(utils::Tree<SGFNode>& SGFTree, unsigned& FFVersion, bool disableWarnings,
+    void handleUnsupportedProperty(const SGFPropertySet& nodeProperties, const SGFPropertySet& treeProperties,
+                                   unsigned& FFVersion, size_t offset, std::vector<Diagnostic>& diagnostics,
                                    bool fixFileFormat) {
 
         unsigned oldFF = FFVersion;
 
-        auto offendingProperty = SGFTree.get().getInvalidProperties(FFVersion)[0];
+        auto offendingProperty = getInvalidProperties(nodeProperties, FFVersion)[0];
 
         if (fixFileFormat){
             // fix the file format if we can
-            std::unordered_set<SGFProperty> properties = getTreeProperties(SGFTree);
-            auto possibleVersions = getPossibleSGFVersions(properties);
+            auto possibleVersions = getPossibleSGFVersions(treeProperties);
 
             // update to the latest possible File format
             if (not possibleVersions.empty()){
@@ -113,19 +128,16 @@ namespace sente::SGF {
 
         }
 
-        if (SGFTree.get().getInvalidProperties(FFVersion).empty()){
+        if (getInvalidProperties(nodeProperties, FFVersion).empty()){
 
-            // if the file format was fixed, issue a warning to the user if they have warnings enabled
-            if (not disableWarnings){
+            // if the file format was fixed, record a warning for the user
+            std::string message = "The Property \"" +
+                                  toStr(offendingProperty) +
+                                  "\" is not supported on this version of SGF (FF[" +
+                                  std::to_string(oldFF) + "])\nThe file was automatically converted to FF[" +
+                                  std::to_string(FFVersion) + "]";
 
-                std::string message = "The Property \"" +
-                                      toStr(offendingProperty) +
-                                      "\" is not supported on this version of SGF (FF[" +
-                                      std::to_string(oldFF) + "])\nThe file was automatically converted to FF[" +
-                                      std::to_string(FFVersion) + "]";
-
-                warn(message);
-            }
+            diagnostics.push_back({message, offset});
         }
         else {
             throw utils::InvalidSGFException("The Property \"" +
@@ -135,8 +147,32 @@ namespace sente::SGF {
         }
     }
 
-    SGFNode nodeFromText(const std::string& SGFText, bool disableWarnings,
-                                                     bool ignoreIllegalProperties){
+    /**
+     *
+     * finds the end of a property value (or the next escaped character inside of it)
+     *
+     * values (especially comments) make up most of a typical SGF file, so they are searched with memchr rather than
+     * being looked at one character at a time
+     *
+     * @param SGFText text to search
+     * @param start index to start searching from
+     * @return index of the next ']' or '\\' at or after start (or the size of the text if there is neither)
+     */
+    size_t findValueEnd(std::string_view SGFText, size_t start){
+
+        const char* begin = SGFText.data() + start;
+        size_t length = SGFText.size() - start;
+
+        auto close = static_cast<const char*>(std::memchr(begin, ']', length));
+        auto escape = static_cast<const char*>(std::memchr(begin, '\\', close ? close - begin : length));
+
+        const char* end = escape ? escape : close;
+        return end ? end - SGFText.data() : SGFText.size();
+
+    }
+
+    SGFNode nodeFromText(std::string_view SGFText, size_t offset, std::vector<Diagnostic>& diagnostics,
+                         const LoadOptions& options, SGFPropertySet* propertyNames){
 
         // std::cout << "entering nodeFromText with text " << SGFText << std::endl;
 
@@ -162,10 +198,25 @@ namespace sente::SGF {
                         // only make a new property if a new property exists
                         if (not temp.empty()){
                             if (isProperty(temp)){
-                                lastProperty = fromStr(strip(temp));
+                                lastProperty = fromStr(temp);
+
+                                if (propertyNames != nullptr){
+                                    propertyNames->set(lastProperty);
+                                }
+
+                                // the values of filtered out properties are skipped
+                                if (not options.properties[lastProperty]){
+                                    lastProperty = NONE;
+                                }
                             }
                             else {
-                                handleUnknownSGFProperty(temp, disableWarnings, ignoreIllegalProperties);
+                                // point the diagnostic at the start of the property name
+                                auto nameStart = previousSlice;
+                                while (std::isspace(*nameStart)){
+                                    nameStart++;
+                                }
+                                handleUnknownSGFProperty(temp, offset + (nameStart - SGFText.begin()),
+                                                         diagnostics, options.ignoreIllegalProperties);
                                 lastProperty = NONE;
                             }
                         }
@@ -176,16 +227,17 @@ namespace sente::SGF {
 
                     inBrackets = true;
 
+                    // jump to the end of the argument
+                    cursor = SGFText.begin() + findValueEnd(SGFText, cursor + 1 - SGFText.begin()) - 1;
+
                     break;
                 case ']':
 
-                    // slice out the argument of the property
-                    temp = strip(std::string(previousSlice, cursor));
-
-                    // if the "last property" value is set, then add the property
-                    // otherwise do nothing
+                    // if the "last property" value is set, then slice out the argument and add the property
+                    // otherwise skip the argument without copying it
                     if (lastProperty != NONE){
-                        node.appendProperty(lastProperty, temp);
+                        node.appendProperty(lastProperty, strip(std::string(previousSlice, cursor)),
+                                            options.stringPool.get());
                     }
 
                     inBrackets = false;
@@ -196,13 +248,16 @@ namespace sente::SGF {
                 case '\\':
                     // skip the next character
                     cursor++;
+                    if (inBrackets and cursor < SGFText.end()){
+                        cursor = SGFText.begin() + findValueEnd(SGFText, cursor + 1 - SGFText.begin()) - 1;
+                    }
                     break;
                 default:
                     break;
             }
         }
 
-        if (*cursor != ']'){
+        if (not SGFText.empty() and SGFText.back() != ']'){
             // TODO: throw an exception if the last item in the sequence is not a closing bracket
         }
 
@@ -210,37 +265,129 @@ namespace sente::SGF {
 
     }
 
-    utils::Tree<SGFNode> loadSGF(const std::string& SGFText, bool disableWarnings,
-                                                      bool ignoreIllegalProperties,
-                                                      bool fixFileFormat){
+    /**
+     *
+     * finds the parenthesis that closes a variation
+     *
+     * @param SGFText text to search
+     * @param start index of the parenthesis that opens the variation
+     * @return index of the matching closing parenthesis
+     */
+    size_t findVariationEnd(std::string_view SGFText, size_t start){
 
-        if (SGFText.empty()){
-            throw utils::InvalidSGFException("File is Empty or unreadable");
+        unsigned depth = 0;
+
+        for (size_t i = start; i < SGFText.size(); i++){
+            switch (SGFText[i]){
+                case '[':
+                    // jump over the value, including any escaped characters in it
+                    i = findValueEnd(SGFText, i + 1);
+                    while (i + 1 < SGFText.size() and SGFText[i] == '\\'){
+                        i = findValueEnd(SGFText, i + 2);
+                    }
+                    break;
+                case '(':
+                    depth++;
+                    break;
+                case ')':
+                    if (--depth == 0){
+                        return i;
+                    }
+                    break;
+                default:
+                    break;
+            }
         }
 
-        bool inBrackets = false;
-        bool firstNode = true;
+        throw utils::InvalidSGFException("Missing Closing parentheses");
 
-        // temporary string variable
-        std::string temp;
+    }
 
-        auto cursor = SGFText.begin();
-        auto previousSlice = cursor;
+    void parseRanges(utils::Tree<SGFNode>& SGFTree, UnparsedVariations& unparsed, utils::NodeID node,
+                     std::vector<Diagnostic>& diagnostics);
+
+    /**
+     *
+     * tokenizes part of an SGF file, inserting the nodes that it finds below the cursor of the tree
+     *
+     * the cursor is returned to where it started once the text has been parsed
+     *
+     * @param SGFText text of the SGF file
+     * @param start index to start parsing at
+     * @param end index to stop parsing at
+     * @param SGFTree tree to insert the nodes into
+     * @param firstNode whether the next node is the root of the tree (set to false once a node has been inserted)
+     * @param state options and file format of the game, side variations are recorded here if lazy is set
+     * @param diagnostics vector to append warnings to
+     * @param lazy whether to record side variations as unparsed ranges rather than parsing them
+     */
+    void parseNodes(std::string_view SGFText, size_t start, size_t end, utils::Tree<SGFNode>& SGFTree,
+                    bool& firstNode, UnparsedVariations& state, std::vector<Diagnostic>& diagnostics, bool lazy){
+
+        const auto& options = state.options;
 
-        unsigned FFVersion;
+        bool inBrackets = false;
+        bool finished = false;
+        bool afterVariation = false;
+
+        auto cursor = SGFText.begin() + start;
+        auto previousSlice = cursor;
 
         std::stack<unsigned> branchDepths{};
 
-        utils::Tree<SGFNode> SGFTree;
-        SGFNode tempNode;
+        // text between previousSlice and the cursor with leading whitespace skipped (this does not copy the text)
+        auto slice = [&](){
+            auto start = previousSlice;
+            while (start < cursor and std::isspace(*start)){
+                start++;
+            }
+            return SGFText.substr(start - SGFText.begin(), cursor - start);
+        };
+
+        auto insertNode = [&](const SGFNode& node, size_t offset){
+
+            if (firstNode){
+                SGFTree = utils::Tree<SGFNode>(node);
+                firstNode = false;
+                if (SGFTree.get().hasProperty(FF)){
+                    state.FFVersion = std::stoi(SGFTree.get().getProperty(FF)[0]);
+                }
+                else {
+                    // the file format must be FF[1] because it's not specified
+                    state.FFVersion = 1;
+                }
+            }
+            else {
+                if (lazy){
+                    // children of a node with unparsed variations (ie. from equal nodes that are merged together)
+                    // have to come after its variations as they would if the whole file was parsed, so parse them first
+                    parseRanges(SGFTree, state, SGFTree.getCursor(), diagnostics);
+                }
+                SGFTree.insert(node);
+            }
+
+            state.treeProperties |= node.getPropertySet();
+
+            // validate the result with the file format version
+            if (not SGFTree.get().getInvalidProperties(state.FFVersion).empty()){
+                handleUnsupportedProperty(SGFTree.get().getPropertySet(), state.treeProperties, state.FFVersion, offset, diagnostics,
+                                          options.fixFileFormat);
+            }
+        };
+
+        auto insertText = [&](std::string_view text){
+            size_t offset = text.data() - SGFText.data();
+            insertNode(nodeFromText(text, offset, diagnostics, options), offset);
+        };
 
         // go through the rest of the tree
 
-        for (; cursor < SGFText.end(); cursor++){
+        for (; cursor < SGFText.begin() + end and not finished; cursor++){
             switch (*cursor){
                 case '[':
-                    // enter brackets
+                    // enter brackets and jump to the end of the property value
                     inBrackets = true;
+                    cursor = SGFText.begin() + findValueEnd(SGFText, cursor + 1 - SGFText.begin()) - 1;
                     break;
                 case ']':
                     // leave brackets
@@ -253,33 +400,33 @@ namespace sente::SGF {
                     break;
                 case '\\':
                     cursor++;
+                    if (inBrackets and cursor < SGFText.end()){
+                        cursor = SGFText.begin() + findValueEnd(SGFText, cursor + 1 - SGFText.begin()) - 1;
+                    }
                     break;
                 case '(':
                     if (not inBrackets){
-                        temp = strip(std::string(previousSlice, cursor));
 
-                        if (not temp.empty()) {
-                            // add the property prior to this one
-                            tempNode = nodeFromText(temp, disableWarnings, ignoreIllegalProperties);
+                        if (lazy and afterVariation and not branchDepths.empty()){
+                            // a variation that follows another one is a side variation, record where it is and
+                            // skip over it (the cursor of the tree is at the node that it branches from)
+                            size_t variationStart = cursor - SGFText.begin();
+                            size_t variationEnd = findVariationEnd(SGFText, variationStart);
 
-                            if (firstNode){
-                                SGFTree = utils::Tree<SGFNode>(tempNode);
-                                firstNode = false;
-                                if (SGFTree.get().hasProperty(FF)){
-                                    FFVersion = std::stoi(SGFTree.get().getProperty(FF)[0]);
-                                }
-                                else {
-                                    // the file format must be FF[1] because it's not specified
-                                    FFVersion = 1;
-                                }
-                            }
-                            else {
-                                SGFTree.insert(tempNode);
-                            }
-                            // validate the result with the file format version
-                            if (not SGFTree.get().getInvalidProperties(FFVersion).empty()){
-                                handleUnsupportedProperty(SGFTree, FFVersion, disableWarnings, fixFileFormat);
-                            }
+                            state.ranges[SGFTree.getCursor()].push_back({variationStart,
+                                                                         variationEnd + 1 - variationStart,
+                                                                         state.FFVersion, state.treeProperties});
+
+                            cursor = SGFText.begin() + variationEnd;
+                            previousSlice = cursor + 1;
+                            break;
+                        }
+
+                        auto text = slice();
+
+                        if (not text.empty()) {
+                            // add the property prior to this one
+                            insertText(text);
                         }
 
                         // with the property added to the tree, the push the depth of the current node onto the stack
@@ -287,41 +434,30 @@ namespace sente::SGF {
 
                         // update the previousSlice
                         previousSlice = cursor + 1;
+                        afterVariation = false;
                     }
                     break;
                 case ')':
                     if (not inBrackets){
 
-                        temp = strip(std::string(previousSlice, cursor));
+                        auto text = slice();
 
-                        if (not temp.empty()) {
+                        if (not text.empty()) {
                             // add the property prior to this one
-                            tempNode = nodeFromText(temp, disableWarnings, ignoreIllegalProperties);
-                            if (firstNode){
-                                SGFTree = utils::Tree<SGFNode>(tempNode);
-                                firstNode = false;
-                                if (SGFTree.get().hasProperty(FF)){
-                                    FFVersion = std::stoi(SGFTree.get().getProperty(FF)[0]);
-                                }
-                                else {
-                                    // the file format must be FF[1] because it's not specified
-                                    FFVersion = 1;
-                                }
-                            }
-                            else {
-                                SGFTree.insert(tempNode);
-                            }
-                            // validate the result with the file format version
-                            if (not SGFTree.get().getInvalidProperties(FFVersion).empty()){
-                                handleUnsupportedProperty(SGFTree, FFVersion, disableWarnings, fixFileFormat);
-                            }
+                            insertText(text);
                         }
 
                         // update the previousSlice
                         previousSlice = cursor + 1;
+                        afterVariation = true;
 
                         // update the depth
-                        if (not branchDepths.empty()){
+                        if (not branchDepths.empty() and options.mainLineOnly){
+                            // the main line runs through the first variation at every branch, so the first variation
+                            // to end is the end of the main line and everything after it is a side variation
+                            finished = true;
+                        }
+                        else if (not branchDepths.empty()){
                             // step up until we reach the previous branch depth
                             while (SGFTree.getDepth() > branchDepths.top()){
                                 SGFTree.stepUp();
@@ -339,35 +475,47 @@ namespace sente::SGF {
 
                         if (previousSlice + 1 < cursor){
                             // get the node from the text
-                            tempNode = nodeFromText(strip(std::string(previousSlice, cursor)),
-                                                    disableWarnings, ignoreIllegalProperties);
-                            if (firstNode){
-                                SGFTree = utils::Tree<SGFNode>(tempNode);
-                                firstNode = false;
-                                if (SGFTree.get().hasProperty(FF)){
-                                    FFVersion = std::stoi(SGFTree.get().getProperty(FF)[0]);
-                                }
-                                else {
-                                    // the file format must be FF[1] because it's not specified
-                                    FFVersion = 1;
-                                }
-                            }
-                            else {
-                                SGFTree.insert(tempNode);
-                            }
-                            // validate the result with the file format version
-                            if (not SGFTree.get().getInvalidProperties(FFVersion).empty()){
-                                handleUnsupportedProperty(SGFTree, FFVersion, disableWarnings, fixFileFormat);
-                            }
+                            insertText(slice());
                         }
 
                         // update the previousSlice
                         previousSlice = cursor + 1;
+                        afterVariation = false;
                         break;
                     }
             }
         }
 
+        if (finished){
+            SGFTree.advanceToRoot();
+        }
+
+    }
+
+    /**
+     *
+     * parses the text of an SGF file into a tree of nodes
+     *
+     * @param SGFText text of the SGF file
+     * @param diagnostics vector to append warnings to
+     * @param state options of the parser, the file format of the game is recorded here
+     * @param lazy whether to record side variations in state rather than parsing them
+     * @return the tree of the game
+     */
+    utils::Tree<SGFNode> parseTree(std::string_view SGFText, std::vector<Diagnostic>& diagnostics,
+                                   UnparsedVariations& state, bool lazy){
+
+        size_t firstDiagnostic = diagnostics.size();
+
+        if (SGFText.empty()){
+            throw utils::InvalidSGFException("File is Empty or unreadable");
+        }
+
+        bool firstNode = true;
+        utils::Tree<SGFNode> SGFTree;
+
+        parseNodes(SGFText, 0, SGFText.size(), SGFTree, firstNode, state, diagnostics, lazy);
+
         if (firstNode){
             throw utils::InvalidSGFException("Unable to find any SGF nodes in file");
         }
@@ -383,34 +531,478 @@ namespace sente::SGF {
             }
         }
 
+        // work out where the new diagnostics are in the file
+        locateDiagnostics(SGFText, diagnostics, firstDiagnostic);
+
         return SGFTree;
 
     }
 
-    void insertIntoSGF(utils::Tree<SGFNode>& moves, std::stringstream& SGF){
+    /**
+     *
+     * parses the text of an SGF file into a tree of nodes
+     *
+     * warnings are recorded in diagnostics rather than issued, so this never touches the python interpreter and may be
+     * called from any thread
+     *
+     * @param SGFText text of the SGF file
+     * @param diagnostics vector to append warnings to
+     * @param options options that control the parser
+     * @return the tree of the game
+     */
+    utils::Tree<SGFNode> loadSGF(std::string_view SGFText, std::vector<Diagnostic>& diagnostics,
+                                                           const LoadOptions& options){
+        UnparsedVariations state;
+        state.options = options;
+        return parseTree(SGFText, diagnostics, state, false);
+    }
+
+    /**
+     *
+     * parses the text of an SGF file into a tree of nodes, issuing python warnings once the file has been parsed
+     *
+     * @param SGFText text of the SGF file
+     * @param disableWarnings whether to skip issuing the warnings
+     * @param options options that control the parser
+     * @return the tree of the game
+     */
+    utils::Tree<SGFNode> loadSGF(std::string_view SGFText, bool disableWarnings, const LoadOptions& options){
+
+        std::vector<Diagnostic> diagnostics;
+        auto tree = loadSGF(SGFText, diagnostics, options);
+
+        if (not disableWarnings){
+            emitWarnings(diagnostics, "");
+        }
+
+        return tree;
 
-        // insert the current node
-        SGF << ";" << std::string(moves.get());
+    }
+
+    utils::Tree<SGFNode> loadSGF(const std::string& SGFText, bool disableWarnings,
+                                                      bool ignoreIllegalProperties,
+                                                      bool fixFileFormat){
+        LoadOptions options;
+        options.ignoreIllegalProperties = ignoreIllegalProperties;
+        options.fixFileFormat = fixFileFormat;
+        return loadSGF(SGFText, disableWarnings, options);
+    }
+
+    /**
+     *
+     * loads a game, only parsing its main line
+     *
+     * side variations are recorded as ranges of the text (which the game keeps) and are parsed when they are first
+     * needed, so errors in a side variation are only found once it is parsed
+     *
+     * @param SGFText text of the SGF file
+     * @param disableWarnings whether to skip issuing warnings (for the main line and the variations)
+     * @param options options that control the parser
+     * @return the game
+     */
+    GoGame loadLazily(std::string SGFText, bool disableWarnings, const LoadOptions& options){
+
+        auto unparsed = std::make_shared<UnparsedVariations>();
+        unparsed->SGFText = std::make_shared<const std::string>(std::move(SGFText));
+        unparsed->options = options;
+        unparsed->disableWarnings = disableWarnings;
+
+        std::vector<Diagnostic> diagnostics;
+        auto tree = parseTree(*unparsed->SGFText, diagnostics, *unparsed, true);
+
+        if (not disableWarnings){
+            emitWarnings(diagnostics, "");
+        }
 
-        if (moves.getDepth() == 0){
-            SGF << std::endl;
+        if (unparsed->ranges.empty()){
+            // there's nothing to parse later, so there's no need to keep the text
+            return GoGame(std::move(tree));
         }
 
-        for (auto& child : moves.getChildren()){
-            if (moves.getChildren().size() != 1){
-                SGF << "\n(";
+        return GoGame(std::move(tree), std::move(unparsed));
+
+    }
+
+    /**
+     *
+     * parses the unparsed variations that branch from a node without issuing warnings for them
+     *
+     * @param SGFTree tree of the game
+     * @param unparsed variations of the game that have not been parsed yet
+     * @param node node to parse the variations of
+     * @param diagnostics vector to append warnings to
+     */
+    void parseRanges(utils::Tree<SGFNode>& SGFTree, UnparsedVariations& unparsed, utils::NodeID node,
+                     std::vector<Diagnostic>& diagnostics){
+
+        auto ranges = unparsed.ranges.find(node);
+
+        if (ranges == unparsed.ranges.end()){
+            return;
+        }
+
+        auto variations = std::move(ranges->second);
+        unparsed.ranges.erase(ranges);
+
+        utils::NodeID cursor = SGFTree.getCursor();
+        SGFTree.setCursor(node);
+
+        // the variations are parsed from the state of the parser where they start rather than wherever the parser
+        // happens to be, and that state is put back once they have been parsed
+        unsigned FFVersion = unparsed.FFVersion;
+        SGFPropertySet treeProperties = unparsed.treeProperties;
+
+        unparsed.FFVersion = variations.front().FFVersion;
+        unparsed.treeProperties = variations.front().treeProperties;
+
+        try {
+            bool firstNode = false;
+            for (const auto& variation : variations){
+                // the variations of a node follow each other in the file, so each one carries on from the state that
+                // the one before it left (as it would if the file was parsed all at once)
+                parseNodes(*unparsed.SGFText, variation.offset, variation.offset + variation.length, SGFTree,
+                           firstNode, unparsed, diagnostics, true);
+            }
+        }
+        catch (...){
+            // put the cursor back, the variations are reported as invalid again if they are needed again
+            SGFTree.setCursor(cursor);
+            unparsed.ranges[node] = std::move(variations);
+            unparsed.FFVersion = FFVersion;
+            unparsed.treeProperties = treeProperties;
+            throw;
+        }
+
+        SGFTree.setCursor(cursor);
+        unparsed.FFVersion = FFVersion;
+        unparsed.treeProperties = treeProperties;
+
+    }
+
+    /**
+     *
+     * parses the side variations that branch from a node of a lazily loaded game
+     *
+     * variations inside of them are recorded as ranges again, so only one level of the tree is parsed at a time
+     *
+     * @param SGFTree tree of the game
+     * @param unparsed variations of the game that have not been parsed yet
+     * @param node node to parse the variations of
+     */
+    void parseVariations(utils::Tree<SGFNode>& SGFTree, UnparsedVariations& unparsed, utils::NodeID node){
+
+        std::vector<Diagnostic> diagnostics;
+
+        parseRanges(SGFTree, unparsed, node, diagnostics);
+
+        if (not unparsed.disableWarnings){
+            locateDiagnostics(*unparsed.SGFText, diagnostics, 0);
+            emitWarnings(diagnostics, "");
+        }
+
+    }
+
+    /**
+     *
+     * makes a property filter
+     *
+     * the properties that are needed to play through the game (moves, setup stones, the board size, rules and so on)
+     * are always kept
+     *
+     * @param properties properties to keep (every property if empty)
+     * @param excludedProperties properties to skip
+     * @return the set of properties to keep
+     */
+    SGFPropertySet makePropertyFilter(const std::vector<SGFProperty>& properties,
+                                      const std::vector<SGFProperty>& excludedProperties){
+
+        SGFPropertySet filter;
+
+        if (properties.empty()){
+            filter.set();
+        }
+        for (auto property : properties){
+            filter.set(property);
+        }
+        for (auto property : excludedProperties){
+            filter.reset(property);
+        }
+
+        for (auto property : {B, W, AB, AW, AE, FF, GM, SZ, RU, KM}){
+            filter.set(property);
+        }
+
+        return filter;
+
+    }
+
+    /**
+     *
+     * reads the entire contents of an SGF file (which may be gzip compressed)
+     *
+     * @param fileName path to the file
+     * @return the text of the file
+     */
+    std::string readSGFFile(const std::string& fileName){
+        return utils::readFile(fileName);
+    }
+
+    /**
+     *
+     * finds the games in an SGF collection, ie. a file of the form "(;...)(;...)..."
+     *
+     * this only counts parentheses (skipping over property values) so it is much faster than parsing the games
+     *
+     * @param SGFText text of the collection
+     * @return the offset and length of each top level game in the text
+     */
+    std::vector<std::pair<size_t, size_t>> splitCollection(std::string_view SGFText){
+
+        std::vector<std::pair<size_t, size_t>> games;
+
+        bool inBrackets = false;
+        unsigned depth = 0;
+        size_t gameStart = 0;
+
+        for (size_t i = 0; i < SGFText.size(); i++){
+            switch (SGFText[i]){
+                case '[':
+                    inBrackets = true;
+                    break;
+                case ']':
+                    inBrackets = false;
+                    break;
+                case '\\':
+                    i++;
+                    break;
+                case '(':
+                    if (not inBrackets){
+                        if (depth == 0){
+                            gameStart = i;
+                        }
+                        depth++;
+                    }
+                    break;
+                case ')':
+                    if (not inBrackets){
+                        if (depth == 0){
+                            throw utils::InvalidSGFException("extra closing parentheses");
+                        }
+                        if (--depth == 0){
+                            games.emplace_back(gameStart, i + 1 - gameStart);
+                        }
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (depth != 0){
+            // let the parser report the error for the unfinished game
+            games.emplace_back(gameStart, SGFText.size() - gameStart);
+        }
+
+        if (games.empty()){
+            throw utils::InvalidSGFException("Unable to find any SGF games in file");
+        }
+
+        return games;
+
+    }
+
+    /**
+     *
+     * loads every game in an SGF collection, parsing the games in parallel
+     *
+     * @param SGFText text of the collection
+     * @param threads number of threads to parse with (0 means one per hardware thread)
+     * @return the games in the order they appear in the collection
+     */
+    std::vector<GoGame> loadCollection(const std::string& SGFText, unsigned threads, bool disableWarnings,
+                                                                                     const LoadOptions& options){
+
+        auto offsets = splitCollection(SGFText);
+        std::vector<std::optional<GoGame>> parsed(offsets.size());
+        std::vector<std::vector<Diagnostic>> diagnostics(offsets.size());
+
+        utils::parallelFor(offsets.size(), threads, [&](size_t i){
+            auto tree = loadSGF(std::string_view(SGFText).substr(offsets[i].first, offsets[i].second),
+                                diagnostics[i], options);
+            parsed[i].emplace(std::move(tree));
+        });
+
+        if (not disableWarnings){
+            // report the warnings relative to the start of the collection, in the order the games appear
+            std::vector<Diagnostic> allDiagnostics;
+            for (size_t i = 0; i < offsets.size(); i++){
+                for (auto& diagnostic : diagnostics[i]){
+                    diagnostic.offset += offsets[i].first;
+                    allDiagnostics.push_back(std::move(diagnostic));
+                }
+            }
+            locateDiagnostics(SGFText, allDiagnostics, 0);
+            emitWarnings(allDiagnostics, "");
+        }
+
+        std::vector<GoGame> games;
+        games.reserve(parsed.size());
+
+        for (auto& game : parsed){
+            games.push_back(std::move(*game));
+        }
+
+        return games;
+
+    }
+
+    /**
+     *
+     * loads a game from each of several SGF files, reading and parsing the files in parallel
+     *
+     * @param fileNames paths to the files
+     * @param threads number of threads to load with (0 means one per hardware thread)
+     * @return the games in the same order as the files
+     */
+    std::vector<GoGame> loadFiles(const std::vector<std::string>& fileNames, unsigned threads, bool disableWarnings,
+                                                                                               const LoadOptions& options){
+
+        std::vector<std::optional<GoGame>> parsed(fileNames.size());
+        std::vector<std::vector<Diagnostic>> diagnostics(fileNames.size());
+
+        utils::parallelFor(fileNames.size(), threads, [&](size_t i){
+            auto tree = loadSGF(readSGFFile(fileNames[i]), diagnostics[i], options);
+            parsed[i].emplace(std::move(tree));
+        });
+
+        if (not disableWarnings){
+            for (size_t i = 0; i < fileNames.size(); i++){
+                emitWarnings(diagnostics[i], fileNames[i]);
             }
-            if (not child.getMove().isResign()){
-
-                // step to the child
-                moves.stepTo(child);
-                // insert the child into the SGF
-                insertIntoSGF(moves, SGF);
-                // step up
-                moves.stepUp();
+        }
+
+        std::vector<GoGame> games;
+        games.reserve(parsed.size());
+
+        for (auto& game : parsed){
+            games.push_back(std::move(*game));
+        }
+
+        return games;
+
+    }
+
+    /**
+     *
+     * loads every SGF file in a ZIP archive, decompressing and parsing the files in parallel
+     *
+     * the files are read straight out of the archive, nothing is extracted to disk
+     *
+     * @param fileName path to the archive
+     * @param threads number of threads to load with (0 means one per hardware thread)
+     * @return the name of each SGF file in the archive along with its game, in the order they appear in the archive
+     */
+    std::vector<std::pair<std::string, GoGame>> loadZip(const std::string& fileName, unsigned threads,
+                                                        bool disableWarnings, const LoadOptions& options){
+
+        utils::ZipArchive archive(fileName);
+
+        auto isSGFFile = [](const std::string& name){
+            // skip the metadata that macOS adds to archives
+            if (name.size() < 4 or name.rfind("__MACOSX/", 0) == 0){
+                return false;
+            }
+            std::string extension = name.substr(name.size() - 4);
+            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+            return extension == ".sgf";
+        };
+
+        std::vector<const utils::ZipEntry*> files;
+        for (const auto& entry : archive.getEntries()){
+            if (isSGFFile(entry.name)){
+                files.push_back(&entry);
+            }
+        }
+
+        std::vector<std::optional<GoGame>> parsed(files.size());
+        std::vector<std::vector<Diagnostic>> diagnostics(files.size());
+
+        utils::parallelFor(files.size(), threads, [&](size_t i){
+            auto tree = loadSGF(archive.read(*files[i]), diagnostics[i], options);
+            parsed[i].emplace(std::move(tree));
+        });
+
+        if (not disableWarnings){
+            for (size_t i = 0; i < files.size(); i++){
+                emitWarnings(diagnostics[i], files[i]->name);
             }
-            if (moves.getChildren().size() != 1){
-                SGF << ")";
+        }
+
+        std::vector<std::pair<std::string, GoGame>> games;
+        games.reserve(parsed.size());
+
+        for (size_t i = 0; i < files.size(); i++){
+            games.emplace_back(files[i]->name, std::move(*parsed[i]));
+        }
+
+        return games;
+
+    }
+
+    void insertIntoSGF(const utils::Tree<SGFNode>& moves, std::stringstream& SGF){
+
+        // pending work for the traversal: either a node to write or a parenthesis that closes/opens a variation
+        enum Action {
+            WRITE_NODE,
+            OPEN_VARIATION,
+            CLOSE_VARIATION
+        };
+
+        std::stack<std::pair<Action, utils::NodeID>> actions;
+        actions.emplace(WRITE_NODE, utils::ROOT_NODE);
+
+        std::vector<utils::NodeID> children;
+
+        while (not actions.empty()){
+
+            auto [action, node] = actions.top();
+            actions.pop();
+
+            switch (action){
+                case OPEN_VARIATION:
+                    SGF << "\n(";
+                    break;
+                case CLOSE_VARIATION:
+                    SGF << ")";
+                    break;
+                case WRITE_NODE:
+
+                    // insert the current node
+                    SGF << ";" << std::string(moves.getPayload(node));
+
+                    if (node == utils::ROOT_NODE){
+                        SGF << std::endl;
+                    }
+
+                    children.clear();
+                    for (utils::NodeID child = moves.getFirstChild(node); child != utils::NO_NODE;
+                         child = moves.getNextSibling(child)){
+                        children.push_back(child);
+                    }
+
+                    // push the children in reverse so that the first child is written first
+                    for (auto child = children.rbegin(); child != children.rend(); child++){
+                        if (children.size() != 1){
+                            actions.emplace(CLOSE_VARIATION, *child);
+                        }
+                        if (not moves.getPayload(*child).getMove().isResign()){
+                            actions.emplace(WRITE_NODE, *child);
+                        }
+                        if (children.size() != 1){
+                            actions.emplace(OPEN_VARIATION, *child);
+                        }
+                    }
+                    break;
             }
         }
 
@@ -418,15 +1010,18 @@ namespace sente::SGF {
 
     std::string dumpSGF(const GoGame& game){
 
-        std::stringstream ss;
+        if (game.hasUnparsedVariations()){
+            // the side variations of a lazily loaded game have to be parsed before they can be written
+            GoGame parsed = game;
+            parsed.parseVariations();
+            return dumpSGF(parsed);
+        }
 
-        // get the tree and advance to the root
-        auto tree = game.getMoveTree();
-        tree.advanceToRoot();
+        std::stringstream ss;
 
         ss << "(";
 
-        insertIntoSGF(tree, ss);
+        insertIntoSGF(game.getMoveTree(), ss);
 
         ss << ")";
 
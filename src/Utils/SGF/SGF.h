@@ -6,8 +6,14 @@
 #define SENTE_SGF_H
 
 #include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <string_view>
+#include <unordered_map>
 
 #include "../Tree.h"
+#include "../StringPool.h"
 #include "SGFProperty.h"
 #include "../../Game/GoGame.h"
 #include "../../Game/GoComponents.h"
@@ -25,11 +31,103 @@
  */
 namespace sente::SGF {
 
+    /**
+     *
+     * a warning produced while parsing an SGF file
+     *
+     */
+    struct Diagnostic {
+        std::string message;
+        size_t offset; // offset of the problem from the start of the text
+        unsigned line = 0; // line and column start from 1
+        unsigned column = 0;
+        bool error = false; // whether the problem stops the file from loading (rather than being a warning)
+    };
+
+    /**
+     *
+     * options that control how SGF files are parsed
+     *
+     */
+    struct LoadOptions {
+        bool ignoreIllegalProperties = true;
+        bool fixFileFormat = true;
+        // properties that are stored in the nodes, the values of other properties are skipped without being copied
+        SGFPropertySet properties = SGFPropertySet().set();
+        // only load the first variation at each branch of the game
+        bool mainLineOnly = false;
+        // pool to intern property values in, so that values repeated across games share storage (none if null)
+        std::shared_ptr<utils::StringPool> stringPool;
+    };
+
+    /**
+     *
+     * a side variation that was skipped by loadLazily
+     *
+     */
+    struct UnparsedRange {
+        size_t offset = 0;
+        size_t length = 0;
+        // file format and properties seen by the parser where the variation starts, so the variation is validated
+        // against the same state no matter when (or after which other variations) it is parsed
+        unsigned FFVersion = 1;
+        SGFPropertySet treeProperties;
+    };
+
+    /**
+     *
+     * side variations of a game that were skipped by loadLazily, they are parsed when they are first needed
+     *
+     * the variations are kept as ranges of the text of the file along with the state of the parser
+     *
+     */
+    struct UnparsedVariations {
+        std::shared_ptr<const std::string> SGFText;
+        // node that the variations branch from -> the variations in the order they appear in the text
+        std::unordered_map<utils::NodeID, std::vector<UnparsedRange>> ranges;
+        LoadOptions options;
+        bool disableWarnings = false;
+        // file format of the game and every property seen so far by the text that is being parsed
+        unsigned FFVersion = 1;
+        SGFPropertySet treeProperties;
+    };
+
+    void locateDiagnostics(std::string_view SGFText, std::vector<Diagnostic>& diagnostics, size_t first);
+    void emitWarnings(const std::vector<Diagnostic>& diagnostics, const std::string& source);
+
+    SGFPropertySet makePropertyFilter(const std::vector<SGFProperty>& properties,
+                                      const std::vector<SGFProperty>& excludedProperties);
+
+    size_t findValueEnd(std::string_view SGFText, size_t start);
+
+    void handleUnsupportedProperty(const SGFPropertySet& nodeProperties, const SGFPropertySet& treeProperties,
+                                   unsigned& FFVersion, size_t offset, std::vector<Diagnostic>& diagnostics,
+                                   bool fixFileFormat);
+
+    SGFNode nodeFromText(std::string_view SGFText, size_t offset, std::vector<Diagnostic>& diagnostics,
+                         const LoadOptions& options, SGFPropertySet* propertyNames = nullptr);
+
     // GoGame loadSGF(const std::string &SGFText);
+    utils::Tree<SGFNode> loadSGF(std::string_view SGFText, std::vector<Diagnostic>& diagnostics,
+                                                           const LoadOptions& options);
+    utils::Tree<SGFNode> loadSGF(std::string_view SGFText, bool disableWarnings, const LoadOptions& options);
     utils::Tree<SGFNode> loadSGF(const std::string& SGFText, bool disableWarnings,
                                                       bool ignoreIllegalProperties,
                                                       bool fixFileFormat);
 
+    GoGame loadLazily(std::string SGFText, bool disableWarnings, const LoadOptions& options);
+    void parseVariations(utils::Tree<SGFNode>& SGFTree, UnparsedVariations& unparsed, utils::NodeID node);
+
+    std::string readSGFFile(const std::string& fileName);
+
+    std::vector<std::pair<size_t, size_t>> splitCollection(std::string_view SGFText);
+    std::vector<GoGame> loadCollection(const std::string& SGFText, unsigned threads, bool disableWarnings,
+                                                                                     const LoadOptions& options);
+    std::vector<GoGame> loadFiles(const std::vector<std::string>& fileNames, unsigned threads, bool disableWarnings,
+                                                                                               const LoadOptions& options);
+    std::vector<std::pair<std::string, GoGame>> loadZip(const std::string& fileName, unsigned threads,
+                                                        bool disableWarnings, const LoadOptions& options);
+
     std::string dumpSGF(const GoGame& game);
     // std::string dumpSGF(const Tree<SGFNode>& game);
 
@@ -126,6 +126,20 @@ namespace sente::SGF {
             WS, // white species
     };
 
+    /**
+     *
+     * stores a property value, sharing it with every other copy of the value if a pool is given
+     *
+     * without a pool the value is stored inline, the same way as a plain std::string
+     *
+     */
+    utils::PooledString makeValue(const std::string& value, utils::StringPool* pool){
+        if (pool != nullptr){
+            return pool->intern(value);
+        }
+        return utils::PooledString(value);
+    }
+
     SGFNode::SGFNode(const Move &move) {
         this->move = move;
     }
@@ -134,7 +148,20 @@ namespace sente::SGF {
         return move;
     }
 
-    void SGFNode::appendProperty(SGFProperty property, const std::string &value) {
+    /**
+     *
+     * gets the stones added by the AB and AW properties of the node
+     *
+     * added stones are not stored with the other properties, so hasProperty(AB) and hasProperty(AW) are always false.
+     * note that their co-ordinates are swapped compared to the co-ordinates of moves.
+     *
+     * @return the added stones
+     */
+    const std::vector<Move>& SGFNode::getAddedMoves() const {
+        return addedMoves;
+    }
+
+    void SGFNode::appendProperty(SGFProperty property, const std::string &value, utils::StringPool* pool) {
         if (property == B or property == W){
 
             if (hasProperty(AW) or hasProperty(AB)){
@@ -182,7 +209,7 @@ namespace sente::SGF {
             std::string copy = value;
             replace(copy, "\\", "\\\\");
             replace(copy, "]", "\\]");
-            properties[property].push_back(value);
+            properties[property].push_back(makeValue(value, pool));
         }
     }
 
@@ -228,12 +255,13 @@ namespace sente::SGF {
             }
         }
         else {
-            std::vector<std::string> copy = values;
-            for (auto & item : copy){
+            std::vector<utils::PooledString> copy;
+            for (auto item : values){
                 replace(item, "\\", "\\\\");
                 replace(item, "]", "\\]");
+                copy.push_back(makeValue(item, nullptr));
             }
-            properties[property] = copy;
+            properties[property] = std::move(copy);
         }
     }
 
@@ -260,20 +288,46 @@ namespace sente::SGF {
 
     std::vector<std::string> SGFNode::getProperty(SGFProperty property) const {
 
-        std::vector<std::string> values = properties.at(property);
+        std::vector<std::string> values;
 
-        for (auto& item : values){
-            replace(item, "\\]", "]");
-            replace(item, "\\\\", "\\");
+        for (const auto& value : properties.at(property)){
+            values.push_back(*value);
+            replace(values.back(), "\\]", "]");
+            replace(values.back(), "\\\\", "\\");
         }
 
         return values;
     }
 
-    std::unordered_map<SGFProperty, std::vector<std::string>> SGFNode::getProperties() const {
+    /**
+     *
+     * gets the first value of a property without copying it
+     *
+     * the value is returned as it appears in the SGF file (escaped characters are not unescaped), which makes no
+     * difference for properties like SZ, KM, RU or RE
+     *
+     * @param property property to get the value of
+     * @return reference to the value
+     */
+    const std::string& SGFNode::getFirstValue(SGFProperty property) const {
+        return *properties.at(property).at(0);
+    }
+
+    const std::unordered_map<SGFProperty, std::vector<utils::PooledString>>& SGFNode::getProperties() const {
         return properties;
     }
 
+    SGFPropertySet SGFNode::getPropertySet() const {
+
+        SGFPropertySet propertySet;
+
+        for (const auto& property : properties){
+            propertySet.set(property.first);
+        }
+
+        return propertySet;
+    }
+
     SGFNode::operator std::string() const {
 
         std::stringstream acc;
@@ -316,7 +370,7 @@ namespace sente::SGF {
             if (properties.find(property) != properties.end()){
                 acc << toStr(property);
                 for (const auto& entry : properties.at(property)){
-                    acc << "[" << entry << "]";
+                    acc << "[" << *entry << "]";
                 }
             }
         }
@@ -328,4 +382,13 @@ namespace sente::SGF {
         return move == other.move;
     }
 
-}
\ No newline at end of file
+}
+
+namespace std {
+
+    size_t hash<sente::SGF::SGFNode>::operator()(const sente::SGF::SGFNode& node) const noexcept {
+        // nodes are compared by their moves, so they are hashed by their moves as well
+        return node.getMove().getCode();
+    }
+
+}
@@ -6,6 +6,7 @@
 #define SENTE_SGFNODE_H
 
 #include "SGFProperty.h"
+#include "../StringPool.h"
 #include "../../Game/Move.h"
 
 namespace sente::SGF {
@@ -18,17 +19,20 @@ namespace sente::SGF {
         explicit SGFNode(const std::vector<std::string>& addedMoves);
 
         Move getMove() const;
+        const std::vector<Move>& getAddedMoves() const;
 
         void setProperty(SGFProperty property, const std::vector<std::string>& value);
-        void appendProperty(SGFProperty property, const std::string& value);
+        void appendProperty(SGFProperty property, const std::string& value, utils::StringPool* pool = nullptr);
 
         bool hasProperty(SGFProperty property) const;
         bool isEmpty() const;
         std::vector<SGFProperty> getInvalidProperties(unsigned version) const;
 
-        std::unordered_map<SGFProperty, std::vector<std::string>> getProperties() const;
+        const std::unordered_map<SGFProperty, std::vector<utils::PooledString>>& getProperties() const;
+        SGFPropertySet getPropertySet() const;
 
         std::vector<std::string> getProperty(SGFProperty property) const;
+        const std::string& getFirstValue(SGFProperty property) const;
 
         explicit operator std::string() const;
         bool operator==(const SGFNode& other) const;
@@ -37,11 +41,19 @@ namespace sente::SGF {
 
         Move move;
         std::vector<Move> addedMoves;
-        std::unordered_map<SGFProperty, std::vector<std::string>> properties;
+        // values may be shared with other nodes (see LoadOptions::stringPool)
+        std::unordered_map<SGFProperty, std::vector<utils::PooledString>> properties;
 
     };
 
 }
 
+namespace std {
+
+    template<>
+    struct hash<sente::SGF::SGFNode> {
+        size_t operator()(const sente::SGF::SGFNode& node) const noexcept;
+    };
+}
 
 #endif //SENTE_SGFNODE_H
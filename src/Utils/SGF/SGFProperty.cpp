@@ -2,6 +2,7 @@
 // Created by arthur wesley on 8/27/21.
 //
 
+#include <array>
 #include <algorithm>
 #include <unordered_map>
 
@@ -146,6 +147,82 @@ namespace sente::SGF {
 
     }
 
+    /**
+     *
+     * gets every property that is legal in a version of SGF
+     *
+     * the properties that are legal in each version are only computed once
+     *
+     * @param version version of SGF (1 to 4)
+     * @return the set of legal properties
+     */
+    const SGFPropertySet& getLegalProperties(unsigned version){
+
+        static const auto legalProperties = [](){
+            std::array<SGFPropertySet, 5> legal;
+            for (unsigned version = 1; version <= 4; version++){
+                for (unsigned property = 0; property < SGF_PROPERTY_COUNT; property++){
+                    legal[version][property] = isSGFLegal(SGFProperty(property), version);
+                }
+            }
+            return legal;
+        }();
+
+        return legalProperties[version];
+
+    }
+
+    /**
+     *
+     * finds the properties in a set that are not legal in a version of SGF
+     *
+     * @param properties set of properties to check
+     * @param version version of SGF
+     * @return the illegal properties
+     */
+    std::vector<SGFProperty> getInvalidProperties(const SGFPropertySet& properties, unsigned version){
+
+        std::vector<SGFProperty> invalidProperties;
+
+        if (version >= 1 and version <= 4 and (properties & ~getLegalProperties(version)).none()){
+            // the common case, every property is legal
+            return invalidProperties;
+        }
+
+        for (unsigned property = 0; property < SGF_PROPERTY_COUNT; property++){
+            if (properties[property] and not isSGFLegal(SGFProperty(property), version)){
+                invalidProperties.push_back(SGFProperty(property));
+            }
+        }
+
+        return invalidProperties;
+
+    }
+
+    /**
+     *
+     * determines which versions of SGF a set of properties is legal in
+     *
+     * the properties that are legal in each version are only computed once, so this runs in constant time
+     *
+     * @param properties set of properties to check
+     * @return a list of the versions of SGF that every property is legal in
+     */
+    std::vector<unsigned> getPossibleSGFVersions(const SGFPropertySet& properties){
+
+        std::vector<unsigned> versions;
+
+        for (unsigned version = 1; version <= 4; version++){
+            // the version is possible if none of the properties are illegal in it
+            if ((properties & ~getLegalProperties(version)).none()){
+                versions.push_back(version);
+            }
+        }
+
+        return versions;
+
+    }
+
     std::unordered_map<std::string, SGFProperty> strToProperty {
             {""     , NONE},
             {stringify(B),   B},
@@ -322,8 +399,10 @@ namespace sente::SGF {
     };
 
     SGFProperty fromStr(const std::string& SGFProperty){
-        if (strToProperty.find(SGFProperty) != strToProperty.end()){
-            return strToProperty[SGFProperty];
+        // find (rather than operator[]) so that parsers on several threads can look properties up at once
+        auto property = strToProperty.find(SGFProperty);
+        if (property != strToProperty.end()){
+            return property->second;
         }
         else {
             throw utils::InvalidSGFException("Invalid SGF command: \"" + SGFProperty + "\"");
@@ -5,7 +5,10 @@
 #ifndef SENTE_SGFPROPERTY_H
 #define SENTE_SGFPROPERTY_H
 
+#include <bitset>
 #include <string>
+#include <vector>
+#include <unordered_set>
 
 namespace sente::SGF {
     enum SGFProperty {
@@ -109,6 +112,11 @@ namespace sente::SGF {
         WS, // white species Changes.txt: support
     };
 
+    // number of entries in the SGFProperty enum (including NONE)
+    const unsigned SGF_PROPERTY_COUNT = WS + 1;
+
+    typedef std::bitset<SGF_PROPERTY_COUNT> SGFPropertySet;
+
     SGFProperty fromStr(const std::string& sgfProperty);
     std::string toStr(SGFProperty property);
 
@@ -116,6 +124,9 @@ namespace sente::SGF {
     bool isFileWide(SGFProperty property);
     bool isSGFLegal(SGFProperty property, unsigned version);
     std::vector<unsigned> getPossibleSGFVersions(const std::unordered_set<SGFProperty>& properties);
+    const SGFPropertySet& getLegalProperties(unsigned version);
+    std::vector<SGFProperty> getInvalidProperties(const SGFPropertySet& properties, unsigned version);
+    std::vector<unsigned> getPossibleSGFVersions(const SGFPropertySet& properties);
 
 
 }
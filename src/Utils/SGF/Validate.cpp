@@ -0,0 +1,516 @@
+//
+// Created on 10/18/26.
+//
+
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <ciso646>
+#include <algorithm>
+#include <stdexcept>
+
+#include "Validate.h"
+#include "../SenteExceptions.h"
+#include "../../Game/GoComponents.h"
+
+namespace sente::SGF {
+
+    /**
+     *
+     * a minimal go board that checks the moves of a game as they are replayed
+     *
+     * the stones are kept in a flat array so that the board is cheap to copy at the start of every variation
+     *
+     */
+    class ReplayBoard {
+    public:
+
+        ReplayBoard() = default;
+
+        ReplayBoard(unsigned side, bool selfCaptureLegal){
+            this->side = side;
+            this->selfCaptureLegal = selfCaptureLegal;
+            stones.assign(side * side, EMPTY);
+        }
+
+        void play(const SGFNode& node, size_t offset, std::vector<Diagnostic>& diagnostics);
+
+    private:
+
+        unsigned side = 0;
+        bool selfCaptureLegal = false;
+
+        std::vector<uint8_t> stones;
+        Move koPoint = Move::nullMove;
+        Stone lastPlayer = EMPTY; // color of the last move that was played (empty if there have been none)
+
+        void addStone(const Move& stone, size_t offset, std::vector<Diagnostic>& diagnostics);
+        void removeStones(const SGFNode& node, size_t offset, std::vector<Diagnostic>& diagnostics);
+        void playMove(const Move& move, size_t offset, std::vector<Diagnostic>& diagnostics);
+
+        unsigned getNeighbors(unsigned point, std::array<unsigned, 4>& neighbors) const;
+        bool findGroup(unsigned start, std::vector<unsigned>& group) const;
+
+    };
+
+    /**
+     *
+     * converts an SGF co-ordinate (a-z then A-Z) into an index
+     *
+     * @return the index of the co-ordinate or -1 if it isn't a letter
+     */
+    int fromSGFCoordinate(char coordinate){
+        if (coordinate >= 'a' and coordinate <= 'z'){
+            return coordinate - 'a';
+        }
+        if (coordinate >= 'A' and coordinate <= 'Z'){
+            return coordinate - 'A' + 26;
+        }
+        return -1;
+    }
+
+    void ReplayBoard::play(const SGFNode& node, size_t offset, std::vector<Diagnostic>& diagnostics){
+
+        // setup stones, AB and AW are stored by the node as added moves while AE is kept as a property
+        for (const auto& stone : node.getAddedMoves()){
+            addStone(stone, offset, diagnostics);
+        }
+        removeStones(node, offset, diagnostics);
+
+        Move move = node.getMove();
+
+        if (move != Move::nullMove){
+            playMove(move, offset, diagnostics);
+        }
+
+    }
+
+    /**
+     *
+     * places a setup stone (from AB or AW) on the board
+     *
+     * the co-ordinates of added stones are swapped relative to those of moves (see SGFNode::appendProperty)
+     *
+     */
+    void ReplayBoard::addStone(const Move& stone, size_t offset, std::vector<Diagnostic>& diagnostics){
+
+        if (stone.getX() >= side or stone.getY() >= side){
+            diagnostics.push_back({std::string("The point \"") + char('a' + stone.getY()) + char('a' + stone.getX()) +
+                                   "\" in " + (stone.getStone() == BLACK ? "AB" : "AW") +
+                                   " is beyond the edge of the go board (check your board size)",
+                                   offset, 0, 0, true});
+            return;
+        }
+
+        stones[stone.getX() * side + stone.getY()] = stone.getStone();
+        koPoint = Move::nullMove;
+
+    }
+
+    /**
+     *
+     * clears the points of an AE property (ie. AE[aa][bb] or AE[aa:cc]) from the board
+     *
+     */
+    void ReplayBoard::removeStones(const SGFNode& node, size_t offset, std::vector<Diagnostic>& diagnostics){
+
+        if (not node.hasProperty(AE)){
+            return;
+        }
+
+        for (const auto& value : node.getProperty(AE)){
+
+            // values are either a single point or a compressed rectangle of points
+            bool isPoint = value.size() == 2;
+            bool isRectangle = value.size() == 5 and value[2] == ':';
+
+            int firstX = value.size() >= 2 ? fromSGFCoordinate(value[0]) : -1;
+            int firstY = value.size() >= 2 ? fromSGFCoordinate(value[1]) : -1;
+            int lastX = isRectangle ? fromSGFCoordinate(value[3]) : firstX;
+            int lastY = isRectangle ? fromSGFCoordinate(value[4]) : firstY;
+
+            if ((not isPoint and not isRectangle) or firstX < 0 or firstY < 0 or lastX < 0 or lastY < 0){
+                diagnostics.push_back({"invalid point \"" + value + "\" in AE", offset, 0, 0, true});
+                continue;
+            }
+
+            if (std::max(firstX, lastX) >= int(side) or std::max(firstY, lastY) >= int(side)){
+                diagnostics.push_back({"The point \"" + value + "\" in AE is beyond the edge of the go board "
+                                       "(check your board size)", offset, 0, 0, true});
+                continue;
+            }
+
+            for (int x = std::min(firstX, lastX); x <= std::max(firstX, lastX); x++){
+                for (int y = std::min(firstY, lastY); y <= std::max(firstY, lastY); y++){
+                    stones[y * side + x] = EMPTY;
+                }
+            }
+        }
+
+        koPoint = Move::nullMove;
+
+    }
+
+    /**
+     *
+     * checks that a move is legal (using the same rules as GoGame::playStone) and plays it
+     *
+     * illegal moves are reported and are not placed on the board
+     *
+     */
+    void ReplayBoard::playMove(const Move& move, size_t offset, std::vector<Diagnostic>& diagnostics){
+
+        Stone player = move.getStone();
+
+        auto illegal = [&](const std::string& message){
+            diagnostics.push_back({message, offset, 0, 0, true});
+            lastPlayer = player;
+        };
+
+        if (move.isPass()){
+            lastPlayer = player;
+            koPoint = Move::nullMove;
+            return;
+        }
+
+        if (move.getX() >= side or move.getY() >= side){
+            illegal("The Desired move " + std::string(move) +
+                    " is beyond the edge of the go board (check your board size)");
+            return;
+        }
+
+        unsigned point = move.getY() * side + move.getX();
+
+        if (stones[point] != EMPTY){
+            illegal("The Desired move " + std::string(move) + " lies on an occupied point");
+            return;
+        }
+        if (lastPlayer == EMPTY ? player != BLACK : player == lastPlayer){
+            illegal(std::string("It is not currently ") + (player == BLACK ? "black" : "white") + "'s turn");
+            return;
+        }
+
+        stones[point] = player;
+
+        // find the groups that the move captures
+        std::vector<unsigned> captured;
+        std::vector<unsigned> group;
+        bool friendlyNeighbor = false;
+        bool surrounded = true;
+
+        std::array<unsigned, 4> neighbors{};
+        unsigned neighborCount = getNeighbors(point, neighbors);
+
+        for (unsigned i = 0; i < neighborCount; i++){
+            unsigned neighbor = neighbors[i];
+            if (stones[neighbor] == player){
+                friendlyNeighbor = true;
+            }
+            if (stones[neighbor] != getOpponent(player)){
+                surrounded = false;
+            }
+            else if (std::find(captured.begin(), captured.end(), neighbor) == captured.end() and
+                     not findGroup(neighbor, group)){
+                captured.insert(captured.end(), group.begin(), group.end());
+            }
+        }
+
+        bool selfCapture = captured.empty() and not findGroup(point, group);
+
+        if (selfCapture and not selfCaptureLegal){
+            stones[point] = EMPTY;
+            illegal("The Desired move " + std::string(move) + " would result in a self-capture");
+            return;
+        }
+        if (move == koPoint){
+            stones[point] = EMPTY;
+            illegal("The Desired move " + std::string(move) + " lies on a Ko point");
+            return;
+        }
+
+        for (unsigned stone : captured){
+            stones[stone] = EMPTY;
+        }
+        if (selfCapture){
+            // self captures are legal under Tromp-Taylor rules
+            for (unsigned stone : group){
+                stones[stone] = EMPTY;
+            }
+        }
+
+        // capturing a single stone with a stone that doesn't touch any of its own stones is a ko
+        koPoint = Move::nullMove;
+        if (captured.size() == 1 and not friendlyNeighbor and surrounded){
+            koPoint = Move(captured[0] % side, captured[0] / side, getOpponent(player));
+        }
+
+        lastPlayer = player;
+
+    }
+
+    /**
+     *
+     * finds the points next to a point
+     *
+     * @param point point to find the neighbors of
+     * @param neighbors array to fill with the neighbors
+     * @return the number of neighbors (less than four on the edge of the board)
+     */
+    unsigned ReplayBoard::getNeighbors(unsigned point, std::array<unsigned, 4>& neighbors) const {
+
+        unsigned count = 0;
+
+        unsigned x = point % side;
+        unsigned y = point / side;
+
+        if (x > 0){
+            neighbors[count++] = point - 1;
+        }
+        if (x + 1 < side){
+            neighbors[count++] = point + 1;
+        }
+        if (y > 0){
+            neighbors[count++] = point - side;
+        }
+        if (y + 1 < side){
+            neighbors[count++] = point + side;
+        }
+
+        return count;
+
+    }
+
+    /**
+     *
+     * finds the group of stones that a stone belongs to
+     *
+     * @param start stone in the group
+     * @param group vector to fill with the stones of the group
+     * @return whether the group has any liberties
+     */
+    bool ReplayBoard::findGroup(unsigned start, std::vector<unsigned>& group) const {
+
+        group.clear();
+        group.push_back(start);
+
+        bool hasLiberties = false;
+
+        std::array<unsigned, 4> neighbors{};
+
+        for (size_t i = 0; i < group.size(); i++){
+            unsigned neighborCount = getNeighbors(group[i], neighbors);
+            for (unsigned j = 0; j < neighborCount; j++){
+                unsigned neighbor = neighbors[j];
+                if (stones[neighbor] == EMPTY){
+                    hasLiberties = true;
+                }
+                else if (stones[neighbor] == stones[start] and
+                         std::find(group.begin(), group.end(), neighbor) == group.end()){
+                    group.push_back(neighbor);
+                }
+            }
+        }
+
+        return hasLiberties;
+
+    }
+
+    /**
+     *
+     * checks that an SGF file can be loaded without building the game
+     *
+     * the file is tokenized in the same way as loadSGF, but each node is only checked (against the file format of the
+     * file) and then thrown away rather than being added to a tree. unlike loadSGF, checking continues after an error
+     * so that every problem with the file is reported.
+     *
+     * @param SGFText text of the SGF file
+     * @param replay whether to replay the moves of every variation and check that they are legal
+     * @return the errors and warnings in the file, in the order they appear
+     */
+    std::vector<Diagnostic> validateSGF(std::string_view SGFText, bool replay){
+
+        std::vector<Diagnostic> diagnostics;
+
+        auto error = [&](const std::string& message, size_t offset){
+            diagnostics.push_back({message, offset, 0, 0, true});
+        };
+
+        if (SGFText.empty()){
+            error("File is Empty or unreadable", 0);
+            locateDiagnostics(SGFText, diagnostics, 0);
+            return diagnostics;
+        }
+
+        // only the properties needed to replay the game are stored, the values of the rest are skipped
+        LoadOptions options;
+        options.properties = makePropertyFilter({B, W}, {});
+
+        bool inBrackets = false;
+        bool firstNode = true;
+        size_t previousSlice = 0;
+
+        unsigned FFVersion = 1;
+        SGFPropertySet treeProperties;
+
+        // depth of the current node below the root (this mirrors the depth of the tree in loadSGF)
+        unsigned depth = 0;
+
+        ReplayBoard board;
+        // depth and position at the start of each open variation
+        std::vector<std::pair<unsigned, ReplayBoard>> branches;
+
+        // text between previousSlice and end with leading whitespace skipped
+        auto slice = [&](size_t end){
+            size_t start = previousSlice;
+            while (start < end and std::isspace(SGFText[start])){
+                start++;
+            }
+            return SGFText.substr(start, end - start);
+        };
+
+        auto checkRoot = [&](const SGFNode& root, size_t offset){
+
+            if (root.hasProperty(GM) and root.getProperty(GM)[0] != "1"){
+                error("Game is not a Go Game (Sente only parses Go Games)", offset);
+            }
+
+            // the same checks as the GoGame constructor
+            unsigned side = root.hasProperty(SZ) ? std::stoi(root.getProperty(SZ)[0]) : 19;
+            if (side != 9 and side != 13 and side != 19){
+                error("Invalid Board size " + std::to_string(side) +
+                      " only 9x9, 13x13 and 19x19 are currently supported", offset);
+                replay = false;
+            }
+            if (root.hasProperty(KM) and not root.getProperty(KM)[0].empty()){
+                std::stod(root.getProperty(KM)[0]);
+            }
+
+            Rules rules = root.hasProperty(RU) ? rulesFromStr(root.getProperty(RU)[0]) : CHINESE;
+
+            if (replay){
+                board = ReplayBoard(side, rules == TROMP_TAYLOR);
+
+                // the variations that were opened before the root start from the empty board
+                for (auto& branch : branches){
+                    branch.second = board;
+                }
+            }
+        };
+
+        auto checkNode = [&](std::string_view text){
+
+            size_t offset = text.data() - SGFText.data();
+
+            try {
+                // the names of the skipped properties are still needed to check the file format
+                SGFPropertySet propertyNames;
+                auto node = nodeFromText(text, offset, diagnostics, options, &propertyNames);
+
+                if (firstNode){
+                    firstNode = false;
+                    FFVersion = node.hasProperty(FF) ? std::stoi(node.getProperty(FF)[0]) : 1;
+                    checkRoot(node, offset);
+                }
+                else {
+                    depth++;
+                }
+
+                treeProperties |= propertyNames;
+
+                if (not getInvalidProperties(propertyNames, FFVersion).empty()){
+                    handleUnsupportedProperty(propertyNames, treeProperties, FFVersion, offset, diagnostics, true);
+                }
+
+                if (replay){
+                    board.play(node, offset, diagnostics);
+                }
+            }
+            catch (const utils::InvalidSGFException& exception){
+                error(exception.what(), offset);
+            }
+            catch (const std::logic_error&){
+                // std::stoi and std::stod throw invalid_argument and out_of_range
+                error("invalid number in SGF node", offset);
+            }
+        };
+
+        for (size_t cursor = 0; cursor < SGFText.size(); cursor++){
+            switch (SGFText[cursor]){
+                case '[':
+                    // enter brackets and jump to the end of the property value
+                    inBrackets = true;
+                    cursor = findValueEnd(SGFText, cursor + 1) - 1;
+                    break;
+                case ']':
+                    if (inBrackets){
+                        inBrackets = false;
+                    }
+                    else {
+                        error("Extra Closing Bracket", cursor);
+                    }
+                    break;
+                case '\\':
+                    cursor++;
+                    if (inBrackets and cursor < SGFText.size()){
+                        cursor = findValueEnd(SGFText, cursor + 1) - 1;
+                    }
+                    break;
+                case '(':
+                    if (not inBrackets){
+                        auto text = slice(cursor);
+                        if (not text.empty()){
+                            checkNode(text);
+                        }
+                        branches.emplace_back(depth, board);
+                        previousSlice = cursor + 1;
+                    }
+                    break;
+                case ')':
+                    if (not inBrackets){
+                        auto text = slice(cursor);
+                        if (not text.empty()){
+                            checkNode(text);
+                        }
+                        previousSlice = cursor + 1;
+
+                        if (branches.empty()){
+                            error("extra closing parentheses", cursor);
+                        }
+                        else {
+                            // return to the position at the start of the variation
+                            depth = branches.back().first;
+                            board = std::move(branches.back().second);
+                            branches.pop_back();
+                        }
+                    }
+                    break;
+                case ';':
+                    if (not inBrackets){
+                        if (previousSlice + 1 < cursor){
+                            checkNode(slice(cursor));
+                        }
+                        previousSlice = cursor + 1;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        if (inBrackets){
+            error("Missing Closing Bracket", SGFText.size());
+        }
+        if (firstNode){
+            error("Unable to find any SGF nodes in file", 0);
+        }
+        else if (depth != 0){
+            error("Missing Closing parentheses", SGFText.size());
+        }
+
+        locateDiagnostics(SGFText, diagnostics, 0);
+
+        return diagnostics;
+
+    }
+
+}
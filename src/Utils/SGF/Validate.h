@@ -0,0 +1,19 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_VALIDATE_H
+#define SENTE_VALIDATE_H
+
+#include <vector>
+#include <string_view>
+
+#include "SGF.h"
+
+namespace sente::SGF {
+
+    std::vector<Diagnostic> validateSGF(std::string_view SGFText, bool replay);
+
+}
+
+#endif //SENTE_VALIDATE_H
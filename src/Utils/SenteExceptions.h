@@ -6,7 +6,9 @@
 #define SENTE_SENTEEXCEPTIONS_H
 
 #include <ciso646>
+#include <string>
 #include <exception>
+#include <stdexcept>
 
 #include "../Game/Move.h"
 
@@ -25,6 +27,12 @@ namespace sente::utils{
             explicit FileNotFoundException(const std::string &message) : std::domain_error(message){}
         };
 
+        class FileWriteException : public std::domain_error{
+        public:
+            explicit FileWriteException(const std::string &fileName)
+                : std::domain_error("unable to write to \"" + fileName + "\""){}
+        };
+
         class InvalidSGFException : public std::domain_error{
         public:
             explicit InvalidSGFException(const std::string &message);
@@ -0,0 +1,92 @@
+//
+// Created on 10/18/26.
+//
+
+#include "StringPool.h"
+
+namespace sente::utils {
+
+    /**
+     *
+     * finds the shared copy of a string, adding it to the pool if it isn't there yet
+     *
+     * @param value string to intern
+     * @return the shared copy of the string
+     */
+    PooledString StringPool::intern(std::string_view value){
+
+        size_t hash = std::hash<std::string_view>()(value);
+        auto& shard = shards[hash % SHARD_COUNT];
+
+        std::lock_guard<std::mutex> guard(shard.lock);
+
+        auto found = shard.strings.find(value);
+        if (found != shard.strings.end()){
+            return PooledString(found->second);
+        }
+
+        auto pooled = std::make_shared<const std::string>(value);
+        shard.strings.emplace(*pooled, pooled);
+        return PooledString(std::move(pooled));
+
+    }
+
+    /**
+     *
+     * the number of distinct strings in the pool
+     *
+     */
+    size_t StringPool::size() const {
+
+        size_t count = 0;
+
+        for (const auto& shard : shards){
+            std::lock_guard<std::mutex> guard(shard.lock);
+            count += shard.strings.size();
+        }
+
+        return count;
+
+    }
+
+    /**
+     *
+     * removes the strings that are only held by the pool (ie. after the games that used them have been freed)
+     *
+     * @return the number of strings that were removed
+     */
+    size_t StringPool::releaseUnused(){
+
+        size_t released = 0;
+
+        for (auto& shard : shards){
+
+            std::lock_guard<std::mutex> guard(shard.lock);
+
+            // nothing can take a new reference to a string while its shard is locked
+            for (auto it = shard.strings.begin(); it != shard.strings.end();){
+                if (it->second.use_count() == 1){
+                    it = shard.strings.erase(it);
+                    released++;
+                }
+                else {
+                    it++;
+                }
+            }
+        }
+
+        return released;
+
+    }
+
+    /**
+     *
+     * the pool shared by every load in the process that asks for interned values
+     *
+     */
+    const std::shared_ptr<StringPool>& StringPool::global(){
+        static const auto pool = std::make_shared<StringPool>();
+        return pool;
+    }
+
+}
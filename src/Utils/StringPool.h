@@ -0,0 +1,84 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_STRINGPOOL_H
+#define SENTE_STRINGPOOL_H
+
+#include <array>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <variant>
+#include <string_view>
+#include <unordered_map>
+
+namespace sente::utils {
+
+    /**
+     *
+     * a string that may be shared with other holders of the same value
+     *
+     * values that aren't interned are stored inline like a plain std::string, so loads without a pool don't pay for
+     * an extra allocation or for reference counting. interned values hold a reference to the copy in the pool.
+     *
+     */
+    class PooledString {
+    public:
+
+        PooledString() = default;
+        explicit PooledString(std::string value) : storage(std::move(value)) {}
+        explicit PooledString(std::shared_ptr<const std::string> pooled) : storage(std::move(pooled)) {}
+
+        const std::string& operator*() const {
+            if (const auto* pooled = std::get_if<std::shared_ptr<const std::string>>(&storage)){
+                return **pooled;
+            }
+            return std::get<std::string>(storage);
+        }
+
+        const std::string* operator->() const {
+            return &**this;
+        }
+
+    private:
+
+        std::variant<std::string, std::shared_ptr<const std::string>> storage;
+
+    };
+
+    /**
+     *
+     * interns strings so that every copy of a value shares the same storage
+     *
+     * the pool is split into shards that are locked separately so that games can be parsed on several threads at
+     * once. interned strings are reference counted, so they stay valid after the pool is destroyed.
+     *
+     */
+    class StringPool {
+    public:
+
+        PooledString intern(std::string_view value);
+
+        [[nodiscard]] size_t size() const;
+        size_t releaseUnused();
+
+        static const std::shared_ptr<StringPool>& global();
+
+    private:
+
+        static const size_t SHARD_COUNT = 16;
+
+        struct Shard {
+            mutable std::mutex lock;
+            // the keys are views of the pooled strings
+            std::unordered_map<std::string_view, std::shared_ptr<const std::string>> strings;
+        };
+
+        std::array<Shard, SHARD_COUNT> shards;
+
+    };
+
+}
+
+#endif //SENTE_STRINGPOOL_H
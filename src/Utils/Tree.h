@@ -5,12 +5,30 @@
 #ifndef SENTE_TREE_H
 #define SENTE_TREE_H
 
+#include <string>
 #include <vector>
-#include <memory>
+#include <cstdint>
+#include <utility>
 #include <ciso646>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
 
 namespace sente::utils{
 
+    /**
+     *
+     * nodes are referred to by their index in the tree's node arena
+     *
+     */
+    typedef uint32_t NodeID;
+
+    const NodeID NO_NODE = UINT32_MAX;
+    const NodeID ROOT_NODE = 0;
+
+    // nodes with more children than this get a hashed index of their children
+    const unsigned CHILD_INDEX_THRESHOLD = 8;
+
     template<typename Type>
     struct TreeNode{
 
@@ -19,103 +37,115 @@ namespace sente::utils{
          * RootNode constructor
          *
          */
-        TreeNode(){
-            parent = nullptr;
-        }
+        TreeNode() = default;
 
-        TreeNode(const Type& payload, TreeNode* parent){
+        TreeNode(const Type& payload, NodeID parent){
             this->payload = payload;
             this->parent = parent;
         }
 
-        bool isRoot(){
-            return parent == nullptr;
+        [[nodiscard]] bool isRoot() const {
+            return parent == NO_NODE;
         }
-        bool isLeaf(){
-            return children.empty();
+        [[nodiscard]] bool isLeaf() const {
+            return firstChild == NO_NODE;
         }
 
-        typename std::vector<std::shared_ptr<TreeNode>>::iterator findChild(Type& toFind){
-            return std::find_if(children.begin(), children.end(), [=](std::shared_ptr<TreeNode>& child) mutable {
-                return child->payload == toFind;
-            });
-        }
+        Type payload;
 
-        bool hasChild(Type& toFind){
-            return findChild(toFind) != children.end();
-        }
+        // children form a singly linked list (first child/next sibling), the last child is kept for O(1) appends
+        NodeID parent = NO_NODE;
+        NodeID firstChild = NO_NODE;
+        NodeID lastChild = NO_NODE;
+        NodeID nextSibling = NO_NODE;
 
-        Type payload;
-        TreeNode* parent; // you do not own your parent
-        std::vector<std::shared_ptr<TreeNode>> children; // you do own your children
+        unsigned childCount = 0;
+        unsigned childIndex = NO_NODE; // position of this node's child index (if it has one)
 
     };
 
+    /**
+     *
+     * Tree of payloads with a cursor
+     *
+     * every node lives in a single contiguous arena and refers to its relatives by index, so copying the tree is a
+     * single vector copy and destroying it frees all of the nodes in bulk. nodes are never removed so a NodeID stays
+     * valid for the lifetime of the tree.
+     *
+     * nodes with many children (ie. the first few moves of an opening book) keep a flat map from the hash of each
+     * child's payload to the child, so finding a child does not have to scan every branch. Type must therefore be
+     * hashable with std::hash and payloads that compare equal must hash equally.
+     *
+     */
     template<typename Type>
     class Tree{
     public:
 
         Tree(){
-
-            depth = 0;
-            size = 0;
-
-            root = std::make_shared<TreeNode<Type>>(); // create the root
-            cursor = root.get();
+            cursor = ROOT_NODE;
+            nodes.emplace_back(); // create the root
         }
 
-
-        explicit Tree(Type& payload){
-            depth = 0;
-            size = 0;
-
-            root = std::make_shared<TreeNode<Type>>(payload, nullptr); // create the root
-            cursor = root.get();
+        explicit Tree(const Type& payload){
+            cursor = ROOT_NODE;
+            nodes.emplace_back(payload, NO_NODE); // create the root
         }
 
-        void insert(Type& payload){
-            if (not cursor->hasChild(payload)){
+        void insert(const Type& payload){
+            NodeID child = findChild(cursor, payload);
+            if (child == NO_NODE){
                 // if the move isn't already a child node, insert it
-                cursor->children.push_back(std::make_shared<TreeNode<Type>>(payload, cursor));
-                cursor = cursor->children.back().get();
-                depth++;
-                size++;
-            }
-            else {
-                // if we already have this move, step down to it
-                stepTo(payload);
+                child = appendChild(cursor, payload);
             }
+            // step down to the (possibly new) child
+            cursor = child;
+            path.push_back(child);
         }
-        void insertNoStep(Type& payload){
+        void insertNoStep(const Type& payload){
             // only insert if the payload doesn't already exist
-            if (not cursor->hasChild(payload)) {
-                cursor->children.push_back(std::make_shared<TreeNode<Type>>(payload, cursor));
-                size++;
+            if (findChild(cursor, payload) == NO_NODE) {
+                appendChild(cursor, payload);
             }
         }
+        NodeID insertChild(NodeID parent, const Type& payload){
+            // insert below any node without moving the cursor
+            NodeID child = findChild(parent, payload);
+            if (child == NO_NODE){
+                child = appendChild(parent, payload);
+            }
+            return child;
+        }
 
         void stepUp(){
-            if (not cursor->isRoot()){
-                cursor = cursor->parent;
-                depth--;
+            if (not nodes[cursor].isRoot()){
+                cursor = nodes[cursor].parent;
+                path.pop_back();
             }
             else {
                 throw std::domain_error("cannot step up past root node");
             }
         }
         void stepDown(){
-            if (not cursor->isLeaf()){
-                cursor = cursor->children[0].get(); // step into the first branch
-                depth++;
+            if (not nodes[cursor].isLeaf()){
+                cursor = nodes[cursor].firstChild; // step into the first branch
+                path.push_back(cursor);
             }
             else{
                 throw std::domain_error("cannot infer child to step to (no children to step to)");
             }
         }
-        void stepTo(Type& value){
-            if (cursor->hasChild(value)){
-                cursor = cursor->findChild(value)->get();
-                depth++;
+        void stepToChild(NodeID child){
+            if (nodes[child].parent != cursor){
+                throw std::domain_error("cannot step to a node that is not a child of the cursor");
+            }
+            cursor = child;
+            path.push_back(child);
+        }
+        void stepTo(const Type& value){
+            NodeID child = findChild(cursor, value);
+            if (child != NO_NODE){
+                cursor = child;
+                path.push_back(child);
             }
             else {
                 throw std::domain_error("could not step to child node: the desired value " + std::string(value) + " could not be located");
@@ -123,23 +153,39 @@ namespace sente::utils{
         }
 
         void advanceToRoot(){
-            cursor = root.get();
-            depth = 0;
+            cursor = ROOT_NODE;
+            path.clear();
+        }
+        void setCursor(NodeID node){
+            // rebuild the path by walking up to the root
+            cursor = node;
+            path.clear();
+            for (NodeID temp = node; not nodes[temp].isRoot(); temp = nodes[temp].parent){
+                path.push_back(temp);
+            }
+            std::reverse(path.begin(), path.end());
         }
 
-        Type& get() const{
-            return cursor->payload;
+        Type& get(){
+            return nodes[cursor].payload;
+        }
+        const Type& get() const{
+            return nodes[cursor].payload;
         }
 
-        Type& getRoot() const {
-            return root->payload;
+        Type& getRoot(){
+            return nodes[ROOT_NODE].payload;
+        }
+        const Type& getRoot() const {
+            return nodes[ROOT_NODE].payload;
         }
 
         [[nodiscard]] unsigned getDepth() const{
-            return depth;
+            return path.size();
         }
         [[nodiscard]] unsigned getSize() const{
-            return size;
+            // the root node is not counted
+            return nodes.size() - 1;
         }
 
         /**
@@ -148,60 +194,156 @@ namespace sente::utils{
          *
          * @return
          */
-        std::vector<Type> getSequence(){
+        std::vector<Type> getSequence() const {
 
-            // copy the cursor
-            auto temp = cursor;
-            std::vector<Type> moves;
+            std::vector<Type> items;
+            items.reserve(path.size());
 
-            while (not temp->isRoot()){
-                moves.push_back(temp->payload); // add the current item
-                temp = temp->parent; // step up
+            for (NodeID node : path){
+                items.push_back(nodes[node].payload);
             }
 
-            // reverse the vector
-            return std::vector<Type>(moves.rbegin(), moves.rend());
+            return items;
 
         }
 
-        std::vector<Type> getChildren() const {
-            std::vector<Type> children;
-
-            for (const auto& child : cursor->children){
-                children.push_back(child->payload);
-            }
+        /**
+         *
+         * get the nodes that lead from the root to the cursor node (the root itself is not included)
+         *
+         * the path is maintained as the cursor moves, so this does not need to walk the tree
+         *
+         * @return
+         */
+        const std::vector<NodeID>& getPath() const {
+            return path;
+        }
 
-            return children;
+        std::vector<Type> getChildren() const {
+            return getChildren(cursor);
         }
 
         std::vector<Type> getRootChildren() const {
-            std::vector<Type> children;
-
-            for (const auto& child : root->children){
-                children.push_back(child->payload);
-            }
-
-            return children;
+            return getChildren(ROOT_NODE);
         }
 
         [[nodiscard]] bool isAtRoot() const {
-            return cursor->isRoot();
+            return nodes[cursor].isRoot();
         }
         [[nodiscard]] bool isAtLeaf() const {
-            return cursor->isLeaf();
+            return nodes[cursor].isLeaf();
+        }
+        bool isChild(const Type& item) const {
+            // can we find the item in the list of children
+            return findChild(cursor, item) != NO_NODE;
+        }
+
+        ///
+        /// index based access, used for traversals that should not disturb the cursor
+        ///
+
+        [[nodiscard]] NodeID getCursor() const {
+            return cursor;
+        }
+        [[nodiscard]] NodeID getParent(NodeID node) const {
+            return nodes[node].parent;
+        }
+        [[nodiscard]] NodeID getFirstChild(NodeID node) const {
+            return nodes[node].firstChild;
+        }
+        [[nodiscard]] NodeID getNextSibling(NodeID node) const {
+            return nodes[node].nextSibling;
         }
-        bool isChild(const Type& move){
-            // can we find the move in the list of children
-            return not cursor->children.find(move) == cursor->children.end();
+        const Type& getPayload(NodeID node) const {
+            return nodes[node].payload;
+        }
+
+        NodeID findChild(NodeID parent, const Type& toFind) const {
+
+            if (nodes[parent].childIndex != NO_NODE){
+                // wide nodes: look the child up by its hash
+                const auto& index = childIndices[nodes[parent].childIndex];
+                size_t key = std::hash<Type>()(toFind);
+
+                auto entry = std::lower_bound(index.begin(), index.end(), IndexEntry{key, 0});
+                for (; entry != index.end() and entry->first == key; entry++){
+                    if (nodes[entry->second].payload == toFind){
+                        return entry->second;
+                    }
+                }
+                return NO_NODE;
+            }
+
+            for (NodeID child = nodes[parent].firstChild; child != NO_NODE; child = nodes[child].nextSibling){
+                if (nodes[child].payload == toFind){
+                    return child;
+                }
+            }
+            return NO_NODE;
         }
 
     private:
 
-        unsigned depth; // 4 bytes
-        unsigned size; // 4 bytes
+        typedef std::pair<size_t, NodeID> IndexEntry;
+
+        NodeID cursor; // 4 bytes
+
+        // nodes from the root to the cursor, its size is the depth of the cursor
+        std::vector<NodeID> path; // 24 bytes
 
-        TreeNode<Type>* cursor; // 8 bytes
-        std::shared_ptr<TreeNode<Type>> root; // 16 bytes
+        std::vector<TreeNode<Type>> nodes; // 24 bytes
+
+        // sorted (hash, child) pairs for nodes that have more than CHILD_INDEX_THRESHOLD children
+        std::vector<std::vector<IndexEntry>> childIndices; // 24 bytes
+
+        NodeID appendChild(NodeID parentID, const Type& payload){
+
+            auto child = NodeID(nodes.size());
+            nodes.emplace_back(payload, parentID);
+
+            // link the new node onto the end of the parent's children
+            auto& parent = nodes[parentID];
+            if (parent.isLeaf()){
+                parent.firstChild = child;
+            }
+            else {
+                nodes[parent.lastChild].nextSibling = child;
+            }
+            parent.lastChild = child;
+            parent.childCount++;
+
+            if (parent.childIndex != NO_NODE){
+                // keep the existing index sorted
+                auto& index = childIndices[parent.childIndex];
+                IndexEntry entry{std::hash<Type>()(nodes[child].payload), child};
+                index.insert(std::upper_bound(index.begin(), index.end(), entry), entry);
+            }
+            else if (parent.childCount > CHILD_INDEX_THRESHOLD){
+                // the node just became wide, index all of its children
+                std::vector<IndexEntry> index;
+                index.reserve(parent.childCount);
+
+                for (NodeID temp = parent.firstChild; temp != NO_NODE; temp = nodes[temp].nextSibling){
+                    index.emplace_back(std::hash<Type>()(nodes[temp].payload), temp);
+                }
+                std::sort(index.begin(), index.end());
+
+                parent.childIndex = unsigned(childIndices.size());
+                childIndices.push_back(std::move(index));
+            }
+
+            return child;
+        }
+
+        std::vector<Type> getChildren(NodeID parent) const {
+            std::vector<Type> children;
+
+            for (NodeID child = nodes[parent].firstChild; child != NO_NODE; child = nodes[child].nextSibling){
+                children.push_back(nodes[child].payload);
+            }
+
+            return children;
+        }
 
     };
 
@@ -0,0 +1,258 @@
+//
+// Created on 10/18/26.
+//
+
+#include <limits>
+#include <ciso646>
+#include <algorithm>
+
+#include <zlib.h>
+
+#include "ZipArchive.h"
+#include "LittleEndian.h"
+#include "SenteExceptions.h"
+
+namespace sente::utils {
+
+    // record signatures
+    const uint32_t LOCAL_HEADER_SIGNATURE = 0x04034b50;
+    const uint32_t CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+    const uint32_t END_OF_DIRECTORY_SIGNATURE = 0x06054b50;
+    const uint32_t ZIP64_END_OF_DIRECTORY_SIGNATURE = 0x06064b50;
+    const uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+
+    // fixed sizes of the records
+    const size_t LOCAL_HEADER_SIZE = 30;
+    const size_t CENTRAL_HEADER_SIZE = 46;
+    const size_t END_OF_DIRECTORY_SIZE = 22;
+    const size_t ZIP64_END_OF_DIRECTORY_SIZE = 56;
+    const size_t ZIP64_LOCATOR_SIZE = 20;
+
+    const uint16_t ZIP64_EXTRA_FIELD = 0x0001;
+    const uint16_t ENCRYPTED = 0x0001; // general purpose flag
+
+    const uint16_t STORED = 0;
+    const uint16_t DEFLATED = 8;
+
+    // deflate can't expand data by more than this, so larger sizes in the central directory can't be trusted
+    const uint64_t MAX_DEFLATE_RATIO = 1032;
+
+    /**
+     *
+     * reads a little endian unsigned integer out of the archive, checking that it lies inside of the archive
+     *
+     */
+    template<typename Integer>
+    Integer readInteger(const MappedFile& file, uint64_t offset){
+        if (offset > file.size() or file.size() - offset < sizeof(Integer)){
+            throw InvalidSGFException("invalid ZIP archive: unexpected end of file");
+        }
+        return loadInteger<Integer>(file.data() + offset);
+    }
+
+    ZipArchive::ZipArchive(const std::string& fileName) : file(fileName){
+
+        if (file.size() < END_OF_DIRECTORY_SIZE){
+            throw InvalidSGFException("invalid ZIP archive: \"" + fileName + "\" is too small");
+        }
+
+        // the end of central directory record is at the end of the file, followed by a comment of up to 64KiB
+        uint64_t end = file.size() - END_OF_DIRECTORY_SIZE;
+        uint64_t searchLimit = end > 0xFFFF ? end - 0xFFFF : 0;
+
+        while (readInteger<uint32_t>(file, end) != END_OF_DIRECTORY_SIGNATURE){
+            if (end == searchLimit){
+                throw InvalidSGFException("invalid ZIP archive: \"" + fileName + "\" has no central directory");
+            }
+            end--;
+        }
+
+        uint64_t entryCount = readInteger<uint16_t>(file, end + 10);
+        uint64_t directoryOffset = readInteger<uint32_t>(file, end + 16);
+
+        // large archives (ie. more than 65535 entries) keep the real values in a ZIP64 record
+        if (end >= ZIP64_LOCATOR_SIZE and
+            readInteger<uint32_t>(file, end - ZIP64_LOCATOR_SIZE) == ZIP64_LOCATOR_SIGNATURE){
+
+            auto record = readInteger<uint64_t>(file, end - ZIP64_LOCATOR_SIZE + 8);
+
+            if (readInteger<uint32_t>(file, record) != ZIP64_END_OF_DIRECTORY_SIGNATURE or
+                file.size() - record < ZIP64_END_OF_DIRECTORY_SIZE){
+                throw InvalidSGFException("invalid ZIP archive: \"" + fileName + "\" has a corrupt ZIP64 record");
+            }
+
+            entryCount = readInteger<uint64_t>(file, record + 32);
+            directoryOffset = readInteger<uint64_t>(file, record + 48);
+        }
+
+        entries.reserve(std::min<uint64_t>(entryCount, file.size() / CENTRAL_HEADER_SIZE));
+
+        uint64_t offset = directoryOffset;
+
+        for (uint64_t i = 0; i < entryCount; i++){
+
+            if (readInteger<uint32_t>(file, offset) != CENTRAL_HEADER_SIGNATURE){
+                throw InvalidSGFException("invalid ZIP archive: \"" + fileName + "\" has a corrupt central directory");
+            }
+
+            ZipEntry entry;
+
+            entry.flags = readInteger<uint16_t>(file, offset + 8);
+            entry.method = readInteger<uint16_t>(file, offset + 10);
+            entry.crc = readInteger<uint32_t>(file, offset + 16);
+            entry.compressedSize = readInteger<uint32_t>(file, offset + 20);
+            entry.uncompressedSize = readInteger<uint32_t>(file, offset + 24);
+            auto nameLength = readInteger<uint16_t>(file, offset + 28);
+            auto extraLength = readInteger<uint16_t>(file, offset + 30);
+            auto commentLength = readInteger<uint16_t>(file, offset + 32);
+            entry.localHeaderOffset = readInteger<uint32_t>(file, offset + 42);
+
+            uint64_t nameStart = offset + CENTRAL_HEADER_SIZE;
+            if (file.size() - std::min<uint64_t>(nameStart, file.size()) < uint64_t(nameLength) + extraLength){
+                throw InvalidSGFException("invalid ZIP archive: unexpected end of file");
+            }
+            entry.name = std::string(file.data() + nameStart, nameLength);
+
+            // values that don't fit in 32 bits are stored in the ZIP64 extra field, in this order
+            for (uint64_t extra = nameStart + nameLength; extra + 4 <= nameStart + nameLength + extraLength;){
+
+                auto id = readInteger<uint16_t>(file, extra);
+                auto size = readInteger<uint16_t>(file, extra + 2);
+
+                if (id == ZIP64_EXTRA_FIELD){
+                    uint64_t field = extra + 4;
+                    for (uint64_t* value : {&entry.uncompressedSize, &entry.compressedSize,
+                                            &entry.localHeaderOffset}){
+                        if (*value == std::numeric_limits<uint32_t>::max() and field + 8 <= extra + 4 + size){
+                            *value = readInteger<uint64_t>(file, field);
+                            field += 8;
+                        }
+                    }
+                }
+
+                extra += 4 + size;
+            }
+
+            // directories have names ending in a slash and no contents
+            if (entry.name.empty() or entry.name.back() != '/'){
+                entries.push_back(std::move(entry));
+            }
+
+            offset = nameStart + nameLength + extraLength + commentLength;
+        }
+
+    }
+
+    const std::vector<ZipEntry>& ZipArchive::getEntries() const {
+        return entries;
+    }
+
+    /**
+     *
+     * decompresses an entry of the archive
+     *
+     * @param entry entry to read
+     * @return the contents of the entry
+     */
+    std::string ZipArchive::read(const ZipEntry& entry) const {
+
+        if (entry.flags & ENCRYPTED){
+            throw InvalidSGFException("invalid ZIP archive: \"" + entry.name + "\" is encrypted");
+        }
+
+        // the local header repeats the name and has its own extra field, so the data starts after both
+        if (readInteger<uint32_t>(file, entry.localHeaderOffset) != LOCAL_HEADER_SIGNATURE){
+            throw InvalidSGFException("invalid ZIP archive: corrupt header for \"" + entry.name + "\"");
+        }
+
+        uint64_t dataOffset = entry.localHeaderOffset + LOCAL_HEADER_SIZE +
+                              readInteger<uint16_t>(file, entry.localHeaderOffset + 26) +
+                              readInteger<uint16_t>(file, entry.localHeaderOffset + 28);
+
+        if (dataOffset > file.size() or file.size() - dataOffset < entry.compressedSize){
+            throw InvalidSGFException("invalid ZIP archive: \"" + entry.name + "\" is truncated");
+        }
+
+        const char* data = file.data() + dataOffset;
+        std::string contents;
+
+        if (entry.method == STORED){
+
+            if (entry.compressedSize != entry.uncompressedSize){
+                throw InvalidSGFException("invalid ZIP archive: \"" + entry.name + "\" has inconsistent sizes");
+            }
+
+            contents.assign(data, entry.compressedSize);
+        }
+        else if (entry.method == DEFLATED and entry.uncompressedSize != 0){
+
+            // the buffer is allocated up front, so a corrupt (or hostile) size mustn't be allowed to exhaust memory
+            if (entry.uncompressedSize / MAX_DEFLATE_RATIO > entry.compressedSize){
+                throw InvalidSGFException("invalid ZIP archive: \"" + entry.name + "\" has an impossible "
+                                          "uncompressed size");
+            }
+
+            contents.resize(entry.uncompressedSize);
+
+            z_stream stream{};
+
+            // negative window bits: the data is a raw deflate stream without a zlib header
+            if (inflateInit2(&stream, -MAX_WBITS) != Z_OK){
+                throw InvalidSGFException("could not initialize zlib");
+            }
+
+            uint64_t remainingIn = entry.compressedSize;
+            uint64_t remainingOut = entry.uncompressedSize;
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            stream.next_out = reinterpret_cast<Bytef*>(contents.data());
+
+            int status = Z_OK;
+            while (status == Z_OK){
+
+                // zlib counts bytes with 32 bit integers, so feed it huge entries in pieces
+                if (stream.avail_in == 0){
+                    stream.avail_in = uInt(std::min<uint64_t>(remainingIn, std::numeric_limits<uInt>::max()));
+                    remainingIn -= stream.avail_in;
+                }
+                if (stream.avail_out == 0){
+                    stream.avail_out = uInt(std::min<uint64_t>(remainingOut, std::numeric_limits<uInt>::max()));
+                    remainingOut -= stream.avail_out;
+                }
+
+                status = inflate(&stream, Z_NO_FLUSH);
+
+                if (status == Z_BUF_ERROR and (stream.avail_in != 0 or remainingIn != 0) and
+                                              (stream.avail_out != 0 or remainingOut != 0)){
+                    // zlib just needs to be called again
+                    status = Z_OK;
+                }
+            }
+
+            uint64_t written = entry.uncompressedSize - remainingOut - stream.avail_out;
+            inflateEnd(&stream);
+
+            if (status != Z_STREAM_END or written != entry.uncompressedSize){
+                throw InvalidSGFException("invalid ZIP archive: \"" + entry.name + "\" could not be decompressed");
+            }
+
+        }
+        else if (entry.method != DEFLATED){
+            throw InvalidSGFException("invalid ZIP archive: \"" + entry.name + "\" uses an unsupported compression "
+                                      "method (" + std::to_string(entry.method) + ")");
+        }
+
+        uLong crc = crc32(0, nullptr, 0);
+        for (size_t start = 0; start < contents.size(); start += std::numeric_limits<uInt>::max()){
+            auto length = uInt(std::min<size_t>(contents.size() - start, std::numeric_limits<uInt>::max()));
+            crc = crc32(crc, reinterpret_cast<const Bytef*>(contents.data() + start), length);
+        }
+
+        if (crc != entry.crc){
+            throw InvalidSGFException("invalid ZIP archive: \"" + entry.name + "\" is corrupt (CRC mismatch)");
+        }
+
+        return contents;
+
+    }
+
+}
@@ -0,0 +1,59 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef SENTE_ZIPARCHIVE_H
+#define SENTE_ZIPARCHIVE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "MappedFile.h"
+
+namespace sente::utils {
+
+    /**
+     *
+     * a file stored in a ZIP archive, as described by the archive's central directory
+     *
+     */
+    struct ZipEntry {
+        std::string name;
+        uint16_t flags = 0;
+        uint16_t method = 0;
+        uint32_t crc = 0;
+        uint64_t compressedSize = 0;
+        uint64_t uncompressedSize = 0;
+        uint64_t localHeaderOffset = 0;
+    };
+
+    /**
+     *
+     * read only access to the files in a ZIP archive
+     *
+     * the archive is memory mapped and only the central directory is read up front, entries are only decompressed
+     * when they are read. reading entries does not modify the archive, so several threads may read entries at once.
+     *
+     * stored and deflated entries are supported (as well as ZIP64 archives), encrypted entries are not.
+     *
+     */
+    class ZipArchive {
+    public:
+
+        explicit ZipArchive(const std::string& fileName);
+
+        [[nodiscard]] const std::vector<ZipEntry>& getEntries() const;
+
+        [[nodiscard]] std::string read(const ZipEntry& entry) const;
+
+    private:
+
+        MappedFile file;
+        std::vector<ZipEntry> entries;
+
+    };
+
+}
+
+#endif //SENTE_ZIPARCHIVE_H
@@ -9,13 +9,81 @@
 #include <pybind11/functional.h>
 
 #include "Utils/SGF/SGF.h"
+#include "Utils/SGF/Collection.h"
+#include "Utils/SGF/Validate.h"
+#include "Utils/SGF/Corpus.h"
+#include "Utils/SGF/OpeningBook.h"
+#include "Utils/SGF/PositionIndex.h"
+#include "Utils/SGF/Catalog.h"
+#include "Utils/SGF/LiveReader.h"
+#include "Utils/SGF/Positions.h"
+#include "Utils/SGF/DataLoader.h"
 #include "Game/GoGame.h"
 #include "Utils/Numpy.h"
+#include "Utils/Compression.h"
 #include "Utils/SenteExceptions.h"
 #include "Utils/GTP/Session.h"
 
 namespace py = pybind11;
 
+/**
+ *
+ * builds the options for the SGF parser from the arguments of a python function
+ *
+ * @param properties names of the SGF properties to keep (every property if empty)
+ * @param excludedProperties names of the SGF properties to skip
+ * @return options for the SGF parser
+ */
+sente::SGF::LoadOptions makeLoadOptions(bool ignoreIllegalProperties, bool fixFileFormat, bool mainLineOnly,
+                                        bool internValues,
+                                        const std::vector<std::string>& properties = {},
+                                        const std::vector<std::string>& excludedProperties = {}){
+
+    auto toProperties = [](const std::vector<std::string>& names){
+        std::vector<sente::SGF::SGFProperty> converted;
+        for (const auto& name : names){
+            if (not sente::SGF::isProperty(name)){
+                throw py::value_error("Unknown SGF Property: \"" + name + "\"");
+            }
+            converted.push_back(sente::SGF::fromStr(name));
+        }
+        return converted;
+    };
+
+    sente::SGF::LoadOptions options;
+    options.ignoreIllegalProperties = ignoreIllegalProperties;
+    options.fixFileFormat = fixFileFormat;
+    options.properties = sente::SGF::makePropertyFilter(toProperties(properties), toProperties(excludedProperties));
+    options.mainLineOnly = mainLineOnly;
+
+    if (internValues){
+        options.stringPool = sente::utils::StringPool::global();
+    }
+
+    return options;
+
+}
+
+/**
+ *
+ * hands the contents of a vector over to numpy without copying them
+ *
+ * @param values values of the array (the vector is kept alive by the array)
+ * @param shape shape of the array
+ * @return a numpy array that views the values
+ */
+template<typename Type, typename Stored>
+py::array_t<Type> toArray(std::vector<Stored>&& values, const std::vector<size_t>& shape){
+
+    auto* owned = new std::vector<Stored>(std::move(values));
+    py::capsule release(owned, [](void* pointer){
+        delete reinterpret_cast<std::vector<Stored>*>(pointer);
+    });
+
+    return py::array_t<Type>(shape, reinterpret_cast<const Type*>(owned->data()), release);
+
+}
+
 PYBIND11_MODULE(sente, module){
 
     module.doc() = R"pbdoc(
@@ -555,6 +623,27 @@ PYBIND11_MODULE(sente, module){
         .def("numpy", [](const sente::GoGame& game){
             return sente::utils::getFeatures(game, {"Black Stones", "White Stones", "Empty Points", "Ko Points"});
         })
+        .def("to_tensor", [](sente::GoGame& game, const std::vector<std::string>& features, const std::string& line){
+                if (line != "main" and line != "current"){
+                    throw py::value_error("line must be \"main\" or \"current\", not \"" + line + "\"");
+                }
+                return sente::utils::getTensor(game, features, line == "main");
+            },
+            py::arg("features") = std::vector<std::string>{"black_stones", "white_stones", "empty_points",
+                                                          "ko_points"},
+            py::arg("line") = "main",
+            R"pbdoc(
+                Gets the features of every position along a line of the game in a single replay.
+
+                The board is put back where it was afterwards.
+
+                :param features: the names of the features to include (ie. ``["black_stones", "white_stones"]``)
+                :param line: ``"main"`` for the main line of the game or ``"current"`` for the moves leading to the
+                             current position
+                :return: a ``T x features x side x side`` numpy array of the positions that each of the ``T`` moves of
+                         the line was played from, and a numpy array of the ``T`` moves (encoded as
+                         ``x * side + y`` in internal indices, with ``side * side`` for a pass)
+            )pbdoc")
         .def("get_properties", [](const sente::GoGame& game) -> py::dict{
 
                 py::dict response;
@@ -615,32 +704,41 @@ PYBIND11_MODULE(sente, module){
     auto sgf = module.def_submodule("sgf", "utilities for parsing SGF (Smart Game Format) files")
         .def("load", [](const std::string& fileName, bool disableWarnings,
                                                      bool ignoreIllegalProperties,
-                                                     bool fixFileFormat) -> sente::GoGame {
+                                                     bool fixFileFormat,
+                                                     bool mainLineOnly,
+                                                     bool lazyVariations,
+                                                     const std::vector<std::string>& properties,
+                                                     const std::vector<std::string>& excludedProperties,
+                                                     bool internValues) -> sente::GoGame {
+
+                auto options = makeLoadOptions(ignoreIllegalProperties, fixFileFormat, mainLineOnly, internValues,
+                                               properties, excludedProperties);
 
                 py::gil_scoped_release release;
 
                 // load the text from the file
-                std::ifstream filePointer(fileName);
+                std::string SGFText = sente::SGF::readSGFFile(fileName);
 
-                if (not filePointer.good()){
-                    throw sente::utils::FileNotFoundException(fileName);
+                if (lazyVariations){
+                    return sente::SGF::loadLazily(std::move(SGFText), disableWarnings, options);
                 }
 
-                std::string SGFText = std::string((std::istreambuf_iterator<char>(filePointer)),
-                                                  std::istreambuf_iterator<char>());
-                filePointer.close();
-
                 // generate the move tree
-                auto tree = sente::SGF::loadSGF(SGFText, disableWarnings, ignoreIllegalProperties, fixFileFormat);
+                auto tree = sente::SGF::loadSGF(SGFText, disableWarnings, options);
 
                 // set the engine's game to be the move tree
-                return sente::GoGame(tree);
+                return sente::GoGame(std::move(tree));
 
             },
             py::arg("filename"),
             py::arg("disable_warnings") = false,
             py::arg("ignore_illegal_properties") = true,
             py::arg("fix_file_format") = true,
+            py::arg("main_line_only") = false,
+            py::arg("lazy_variations") = false,
+            py::arg("properties") = std::vector<std::string>(),
+            py::arg("exclude_properties") = std::vector<std::string>(),
+            py::arg("intern_values") = false,
             R"pbdoc(
                 Loads a go game from an SGF file.
 
@@ -648,28 +746,171 @@ PYBIND11_MODULE(sente, module){
                 :param disable_warnings: whether to ignore warnings when loading an illegal SGF file
                 :param ignore_illegal_properties: whether or not to ignore illegal SGF properties
                 :param fix_file_format: whether or not to fix the file format if it is wrong
+                :param main_line_only: whether to only load the main line of the game (skipping every variation)
+                :param lazy_variations: whether to only parse side variations when they are first used
+                :param properties: if not empty, only these SGF properties (ie. ``["PB", "PW"]``) are loaded
+                :param exclude_properties: SGF properties (ie. ``["C", "LB"]``) to skip while loading
+                :param intern_values: whether to share the storage of property values with every other game loaded with
+                                      ``intern_values=True`` (saves memory when many games are kept)
                 :return: a ``sente.Game`` object populated with data from the SGF file
             )pbdoc", py::return_value_policy::take_ownership)
+        .def("load_collection", [](const std::string& fileName, unsigned threads, bool disableWarnings,
+                                                                                  bool ignoreIllegalProperties,
+                                                                                  bool fixFileFormat,
+                                                                                  bool mainLineOnly,
+                                                                                  bool internValues){
+
+                auto options = makeLoadOptions(ignoreIllegalProperties, fixFileFormat, mainLineOnly, internValues);
+
+                py::gil_scoped_release release;
+
+                // load the text from the file
+                std::string SGFText = sente::SGF::readSGFFile(fileName);
+
+                // split the collection and parse the games on worker threads
+                return sente::SGF::loadCollection(SGFText, threads, disableWarnings, options);
+
+            },
+            py::arg("filename"),
+            py::arg("threads") = 0,
+            py::arg("disable_warnings") = false,
+            py::arg("ignore_illegal_properties") = true,
+            py::arg("fix_file_format") = true,
+            py::arg("main_line_only") = false,
+            py::arg("intern_values") = false,
+            R"pbdoc(
+                Loads every game from an SGF collection file (a file containing several games, ie. "(;...)(;...)").
+
+                The games are parsed in parallel.
+
+                :param filename: the name of the file
+                :param threads: the number of threads to parse the games with (0 uses one thread per CPU core)
+                :param disable_warnings: whether to ignore warnings when loading an illegal SGF file
+                :param ignore_illegal_properties: whether or not to ignore illegal SGF properties
+                :param fix_file_format: whether or not to fix the file format if it is wrong
+                :param main_line_only: whether to only load the main line of each game (skipping every variation)
+                :param intern_values: whether to share the storage of property values with every other game loaded with
+                                      ``intern_values=True`` (saves memory when many games are kept)
+                :return: a list of ``sente.Game`` objects in the order they appear in the file
+            )pbdoc")
+        .def("load_many", [](const std::vector<std::string>& fileNames, unsigned threads, bool disableWarnings,
+                                                                                          bool ignoreIllegalProperties,
+                                                                                          bool fixFileFormat,
+                                                                                          bool mainLineOnly,
+                                                                                          bool internValues){
+
+                auto options = makeLoadOptions(ignoreIllegalProperties, fixFileFormat, mainLineOnly, internValues);
+
+                py::gil_scoped_release release;
+
+                // read and parse the files on worker threads
+                return sente::SGF::loadFiles(fileNames, threads, disableWarnings, options);
+
+            },
+            py::arg("filenames"),
+            py::arg("threads") = 0,
+            py::arg("disable_warnings") = false,
+            py::arg("ignore_illegal_properties") = true,
+            py::arg("fix_file_format") = true,
+            py::arg("main_line_only") = false,
+            py::arg("intern_values") = false,
+            R"pbdoc(
+                Loads a go game from each of several SGF files.
+
+                The files are read and parsed in parallel.
+
+                :param filenames: a list of file names
+                :param threads: the number of threads to load the files with (0 uses one thread per CPU core)
+                :param disable_warnings: whether to ignore warnings when loading an illegal SGF file
+                :param ignore_illegal_properties: whether or not to ignore illegal SGF properties
+                :param fix_file_format: whether or not to fix the file format if it is wrong
+                :param main_line_only: whether to only load the main line of each game (skipping every variation)
+                :param intern_values: whether to share the storage of property values with every other game loaded with
+                                      ``intern_values=True`` (saves memory when many games are kept)
+                :return: a list of ``sente.Game`` objects in the same order as the file names
+            )pbdoc")
+        .def("load_zip", [](const std::string& fileName, unsigned threads, bool disableWarnings,
+                                                                           bool ignoreIllegalProperties,
+                                                                           bool fixFileFormat,
+                                                                           bool mainLineOnly,
+                                                                           bool internValues){
+
+                auto options = makeLoadOptions(ignoreIllegalProperties, fixFileFormat, mainLineOnly, internValues);
+
+                std::vector<std::pair<std::string, sente::GoGame>> games;
+
+                {
+                    py::gil_scoped_release release;
+                    // inflate and parse the files on worker threads
+                    games = sente::SGF::loadZip(fileName, threads, disableWarnings, options);
+                }
+
+                py::dict result;
+                for (auto& [name, game] : games){
+                    result[py::str(name)] = py::cast(std::move(game));
+                }
+                return result;
+
+            },
+            py::arg("filename"),
+            py::arg("threads") = 0,
+            py::arg("disable_warnings") = false,
+            py::arg("ignore_illegal_properties") = true,
+            py::arg("fix_file_format") = true,
+            py::arg("main_line_only") = false,
+            py::arg("intern_values") = false,
+            R"pbdoc(
+                Loads every SGF file in a ZIP archive without extracting the archive.
+
+                The files are decompressed and parsed in parallel.
+
+                :param filename: the name of the ZIP archive
+                :param threads: the number of threads to load the files with (0 uses one thread per CPU core)
+                :param disable_warnings: whether to ignore warnings when loading an illegal SGF file
+                :param ignore_illegal_properties: whether or not to ignore illegal SGF properties
+                :param fix_file_format: whether or not to fix the file format if it is wrong
+                :param main_line_only: whether to only load the main line of each game (skipping every variation)
+                :param intern_values: whether to share the storage of property values with every other game loaded with
+                                      ``intern_values=True`` (saves memory when many games are kept)
+                :return: a dictionary mapping the name of each SGF file in the archive to its ``sente.Game``
+            )pbdoc")
         .def("dump", [](const sente::GoGame& game, const std::string& fileName){
                 py::gil_scoped_release release;
-                std::ofstream output(fileName);
-                output << sente::SGF::dumpSGF(game);
+                sente::utils::writeFile(fileName, sente::SGF::dumpSGF(game));
             },
              py::arg("game"),
              py::arg("file_name"),
              "saves a game as an SGF")
         .def("loads", [](const std::string& SGFText, bool disableWarnings,
                                                      bool ignoreIllegalProperties,
-                                                     bool fixFileFormat) -> sente::GoGame {
+                                                     bool fixFileFormat,
+                                                     bool mainLineOnly,
+                                                     bool lazyVariations,
+                                                     const std::vector<std::string>& properties,
+                                                     const std::vector<std::string>& excludedProperties,
+                                                     bool internValues) -> sente::GoGame {
+
+                auto options = makeLoadOptions(ignoreIllegalProperties, fixFileFormat, mainLineOnly, internValues,
+                                               properties, excludedProperties);
 
                 py::gil_scoped_release release;
-                auto tree = sente::SGF::loadSGF(SGFText, disableWarnings, ignoreIllegalProperties, fixFileFormat);
-                return sente::GoGame(tree);
+
+                if (lazyVariations){
+                    return sente::SGF::loadLazily(SGFText, disableWarnings, options);
+                }
+
+                auto tree = sente::SGF::loadSGF(SGFText, disableWarnings, options);
+                return sente::GoGame(std::move(tree));
             },
             py::arg("sgf_text"),
             py::arg("disable_warnings") = false,
             py::arg("ignore_illegal_properties") = true,
             py::arg("fix_file_format") = true,
+            py::arg("main_line_only") = false,
+            py::arg("lazy_variations") = false,
+            py::arg("properties") = std::vector<std::string>(),
+            py::arg("exclude_properties") = std::vector<std::string>(),
+            py::arg("intern_values") = false,
             R"pbdoc(
                 Loads a go game from an SGF file.
 
@@ -677,6 +918,12 @@ PYBIND11_MODULE(sente, module){
                 :param disable_warnings: whether to ignore warnings when loading an illegal SGF file
                 :param ignore_illegal_properties: whether or not to ignore illegal SGF properties
                 :param fix_file_format: whether or not to fix the file format if it is wrong
+                :param main_line_only: whether to only load the main line of the game (skipping every variation)
+                :param lazy_variations: whether to only parse side variations when they are first used
+                :param properties: if not empty, only these SGF properties (ie. ``["PB", "PW"]``) are loaded
+                :param exclude_properties: SGF properties (ie. ``["C", "LB"]``) to skip while loading
+                :param intern_values: whether to share the storage of property values with every other game loaded with
+                                      ``intern_values=True`` (saves memory when many games are kept)
                 :return: a ``sente.Game`` object populated with data from the SGF file
             )pbdoc", py::return_value_policy::take_ownership)
         .def("dumps", [](const sente::GoGame& game){
@@ -684,7 +931,641 @@ PYBIND11_MODULE(sente, module){
                 return sente::SGF::dumpSGF(game);
             },
             py::arg("game"),
-            "Serialize a string as an SGF");
+            "Serialize a string as an SGF")
+        .def("validate", [](const std::string& textOrPath, bool replay){
+
+                std::vector<sente::SGF::Diagnostic> diagnostics;
+
+                {
+                    py::gil_scoped_release release;
+
+                    // SGF files start with a parenthesis, so anything else is the name of a file
+                    size_t start = textOrPath.find_first_not_of(" \t\r\n");
+                    if (start == std::string::npos or textOrPath[start] == '('){
+                        diagnostics = sente::SGF::validateSGF(textOrPath, replay);
+                    }
+                    else {
+                        diagnostics = sente::SGF::validateSGF(sente::SGF::readSGFFile(textOrPath), replay);
+                    }
+                }
+
+                py::list problems;
+                for (const auto& diagnostic : diagnostics){
+                    py::dict problem;
+                    problem["message"] = diagnostic.message;
+                    problem["severity"] = diagnostic.error ? "error" : "warning";
+                    problem["line"] = diagnostic.line;
+                    problem["column"] = diagnostic.column;
+                    problem["offset"] = diagnostic.offset;
+                    problems.append(problem);
+                }
+                return problems;
+
+            },
+            py::arg("text_or_path"),
+            py::arg("replay") = true,
+            R"pbdoc(
+                Checks an SGF file for problems without loading it.
+
+                This is much faster than loading the file and playing through it, and unlike loading it, every problem
+                in the file is reported rather than just the first one. The file can be loaded if none of the problems
+                have a severity of "error" (the others are the warnings that loading the file would issue).
+
+                :param text_or_path: the text of an SGF file or the name of one
+                :param replay: whether to replay the moves in every variation and check that they are legal
+                :return: a list of dictionaries with the "message", "severity", "line", "column" and "offset" of each problem
+            )pbdoc");
+
+    py::class_<sente::SGF::Collection>(sgf, "Collection", R"pbdoc(
+            Random access to the games in an SGF collection file (a file containing several games, ie. "(;...)(;...)").
+
+            The first time a collection is opened, the location of each game is saved in an index file next to the
+            collection. After that, loading a game only reads and parses that game.
+        )pbdoc")
+        .def(py::init<const std::string&, const std::string&, unsigned>(),
+            py::arg("filename"),
+            py::arg("index_filename") = "",
+            py::arg("threads") = 0,
+            py::call_guard<py::gil_scoped_release>(),
+            R"pbdoc(
+                Opens an SGF collection, building its index if needed.
+
+                :param filename: the name of the collection file
+                :param index_filename: the name of the index file (defaults to the collection's name followed by ".index")
+                :param threads: the number of threads used to build the index (0 uses one thread per CPU core)
+            )pbdoc")
+        .def("__len__", &sente::SGF::Collection::size)
+        .def("__getitem__", [](const sente::SGF::Collection& collection, long index){
+                if (index < 0){
+                    index += long(collection.size());
+                }
+                if (index < 0 or size_t(index) >= collection.size()){
+                    throw py::index_error("collection index out of range");
+                }
+                py::gil_scoped_release release;
+                return collection.getGame(index, false, true, true);
+            })
+        .def("load", [](const sente::SGF::Collection& collection, size_t index, bool disableWarnings,
+                                                                                bool ignoreIllegalProperties,
+                                                                                bool fixFileFormat){
+                py::gil_scoped_release release;
+                return collection.getGame(index, disableWarnings, ignoreIllegalProperties, fixFileFormat);
+            },
+            py::arg("index"),
+            py::arg("disable_warnings") = false,
+            py::arg("ignore_illegal_properties") = true,
+            py::arg("fix_file_format") = true,
+            R"pbdoc(
+                Loads a single game from the collection.
+
+                :param index: the index of the game in the collection
+                :param disable_warnings: whether to ignore warnings when loading an illegal SGF file
+                :param ignore_illegal_properties: whether or not to ignore illegal SGF properties
+                :param fix_file_format: whether or not to fix the file format if it is wrong
+                :return: a ``sente.Game`` object populated with data from the game
+            )pbdoc")
+        .def("get_properties", &sente::SGF::Collection::getProperties,
+            py::arg("index"),
+            R"pbdoc(
+                Gets the indexed root properties (PB, PW, DT, RE and SZ) of a game without loading it.
+
+                :param index: the index of the game in the collection
+                :return: a dictionary mapping property names to values for the indexed properties that the game has
+            )pbdoc");
+
+    sgf.def("build_index", [](const std::string& fileName, const std::string& indexFileName, unsigned threads){
+            py::gil_scoped_release release;
+            sente::utils::MappedFile file(fileName);
+            auto entries = sente::SGF::buildIndex(file.view(), threads);
+            sente::SGF::writeIndex(indexFileName.empty() ? fileName + ".index" : indexFileName, entries,
+                                   sente::SGF::fingerprintCollection(file));
+            return entries.size();
+        },
+        py::arg("filename"),
+        py::arg("index_filename") = "",
+        py::arg("threads") = 0,
+        R"pbdoc(
+            Builds (or rebuilds) the index file of an SGF collection.
+
+            :param filename: the name of the collection file
+            :param index_filename: the name of the index file (defaults to the collection's name followed by ".index")
+            :param threads: the number of threads to build the index with (0 uses one thread per CPU core)
+            :return: the number of games in the collection
+        )pbdoc");
+
+    sgf.def("interned_values", [](){
+            return sente::utils::StringPool::global()->size();
+        },
+        R"pbdoc(
+            Counts the distinct property values shared by the games loaded with ``intern_values=True``.
+
+            :return: the number of distinct values
+        )pbdoc");
+
+    sgf.def("release_interned_values", [](){
+            return sente::utils::StringPool::global()->releaseUnused();
+        },
+        R"pbdoc(
+            Frees the shared property values that are no longer used by any game.
+
+            :return: the number of values that were freed
+        )pbdoc");
+
+    py::class_<sente::SGF::LiveReader>(sgf, "LiveReader", R"pbdoc(
+            Follows an SGF file that is still being written (ie. the relay of a live game).
+
+            Each update only parses the text that was added to the file since the last update and adds the new moves
+            to the same game. While the board is at the latest move, it moves along with the game. Relays that rewrite
+            the closing parenthesis after each move are followed too, and if anything that was already read changes,
+            the file is read again from the start.
+        )pbdoc")
+        .def(py::init([](const std::string& fileName, bool ignoreIllegalProperties, bool fixFileFormat){
+                auto options = makeLoadOptions(ignoreIllegalProperties, fixFileFormat, false, false);
+                py::gil_scoped_release release;
+                return std::make_unique<sente::SGF::LiveReader>(fileName, options);
+            }),
+            py::arg("filename"),
+            py::arg("ignore_illegal_properties") = true,
+            py::arg("fix_file_format") = true,
+            R"pbdoc(
+                Opens an SGF file and reads the nodes that have been written so far.
+
+                :param filename: the name of the file
+                :param ignore_illegal_properties: whether or not to ignore illegal SGF properties
+                :param fix_file_format: whether or not to fix the file format if it is wrong
+            )pbdoc")
+        .def("update", &sente::SGF::LiveReader::update,
+            py::call_guard<py::gil_scoped_release>(),
+            R"pbdoc(
+                Reads the text that was added to the file since the last update.
+
+                A node is only added once the node after it (or the end of its variation) has been written.
+
+                :return: the number of nodes that were added to the game
+            )pbdoc")
+        .def_property_readonly("game", &sente::SGF::LiveReader::getGame,
+            py::return_value_policy::reference_internal,
+            R"pbdoc(
+                The game that is being read (the same ``sente.Game`` object after every update).
+            )pbdoc")
+        .def("get_offset", &sente::SGF::LiveReader::getOffset,
+            R"pbdoc(
+                Gets the number of bytes of the file that have been parsed.
+
+                :return: the offset in the file that the next update starts reading from
+            )pbdoc");
+
+    py::class_<sente::SGF::PositionStream>(sgf, "PositionStream", R"pbdoc(
+            An iterator over the positions in the main lines of a set of SGF files (see ``sgf.positions``).
+        )pbdoc")
+        .def("__iter__", [](sente::SGF::PositionStream& stream) -> sente::SGF::PositionStream& {
+                return stream;
+            })
+        .def("__next__", [](sente::SGF::PositionStream& stream){
+
+                std::optional<sente::SGF::Position> position;
+                {
+                    py::gil_scoped_release release;
+                    position = stream.next();
+                }
+
+                if (not position){
+                    throw py::stop_iteration();
+                }
+
+                py::object board;
+
+                if (position->board){
+                    board = py::cast(std::move(position->board));
+                }
+                else {
+                    size_t count = position->features.size() / (position->side * position->side);
+                    py::array_t<uint8_t> features({size_t(position->side), size_t(position->side), count});
+                    std::copy(position->features.begin(), position->features.end(), features.mutable_data());
+                    board = std::move(features);
+                }
+
+                return py::make_tuple(position->moveNumber, board, position->nextMove, position->result);
+            });
+
+    sgf.def("positions", [](const py::object& paths, const std::optional<std::vector<std::string>>& features,
+                            unsigned every, size_t queueSize){
+
+            std::vector<std::string> fileNames;
+            if (py::isinstance<py::str>(paths)){
+                fileNames.push_back(paths.cast<std::string>());
+            }
+            else {
+                fileNames = paths.cast<std::vector<std::string>>();
+            }
+
+            return std::make_unique<sente::SGF::PositionStream>(fileNames,
+                    features ? sente::utils::parseFeatures(*features) : std::vector<sente::utils::feature>(),
+                    every, queueSize);
+        },
+        py::arg("paths"),
+        py::arg("features") = py::none(),
+        py::arg("every") = 1,
+        py::arg("queue_size") = 256,
+        R"pbdoc(
+            Replays the main line of every game in a set of SGF files and yields each position that a move was played
+            from, without loading the games as ``sente.Game`` objects.
+
+            The games are replayed on a background thread that runs ahead of the iterator, keeping up to
+            ``queue_size`` positions ready. Games that can't be loaded and games that start with handicap or other
+            setup stones (``AB`` or ``AW``) are skipped, as games are replayed from the empty board.
+
+            :param paths: an SGF file or a list of SGF files (which may be collections)
+            :param features: the names of the features (ie. ``["black_stones", "white_stones"]``) to yield for each
+                             position as a ``side x side x features`` numpy array, a copy of the board is yielded if
+                             this is ``None``
+            :param every: only yield the position before every ``every`` th move
+            :param queue_size: the number of positions that may be waiting to be taken from the iterator
+            :return: an iterator of ``(move number, board or features, next move, result)`` tuples
+        )pbdoc");
+
+    auto corpus = module.def_submodule("corpus", "utilities for analysing large collections of SGF files");
+
+    corpus.def("stats", [](const std::vector<std::string>& fileNames, unsigned threads){
+
+            sente::SGF::CorpusStats stats;
+
+            {
+                py::gil_scoped_release release;
+                stats = sente::SGF::corpusStats(fileNames, threads);
+            }
+
+            py::dict result;
+            result["games"] = stats.games;
+            result["invalid_files"] = stats.invalidFiles;
+            result["board_sizes"] = stats.boardSizes;
+            result["results"] = stats.results;
+            result["move_counts"] = stats.moveCounts;
+            result["players"] = stats.players;
+            result["unknown_properties"] = stats.unknownProperties;
+            return result;
+
+        },
+        py::arg("paths"),
+        py::arg("threads") = 0,
+        R"pbdoc(
+            Collects summary statistics for a set of SGF files without loading the games.
+
+            The files are scanned in parallel. Files may be gzip compressed and may contain several games.
+
+            :param paths: the names of the SGF files
+            :param threads: the number of threads to scan the files with (0 uses one thread per CPU core)
+            :return: a dictionary with the number of "games", the number of "invalid_files" (files that could not be
+                     read or split into games) and histograms of the "board_sizes", "results" (ie. "B+R" or "W+"), main line
+                     "move_counts", games per player ("players") and "unknown_properties"
+        )pbdoc");
+
+    corpus.def("duplicates", [](const std::vector<std::string>& fileNames, unsigned threads, unsigned minMoves){
+
+            std::vector<std::vector<sente::SGF::GameReference>> clusters;
+
+            {
+                py::gil_scoped_release release;
+                clusters = sente::SGF::findDuplicates(fileNames, threads, minMoves);
+            }
+
+            py::list result;
+            for (const auto& cluster : clusters){
+                py::list games;
+                for (const auto& game : cluster){
+                    games.append(py::make_tuple(fileNames[game.file], game.game));
+                }
+                result.append(games);
+            }
+            return result;
+
+        },
+        py::arg("paths"),
+        py::arg("threads") = 0,
+        py::arg("min_moves") = 1,
+        R"pbdoc(
+            Finds the games that appear more than once in a set of SGF files.
+
+            Games are compared by their handicap stones and the moves of their main line, so copies of a game that
+            have different metadata (ie. from different servers) or that are rotated or reflected versions of each
+            other are duplicates.
+            The files are loaded in parallel and games that can't be loaded are skipped.
+
+            :param paths: the names of the SGF files
+            :param threads: the number of threads to load the files with (0 uses one thread per CPU core)
+            :param min_moves: games with fewer moves than this are ignored
+            :return: a list of groups of duplicate games, each game is a tuple of the name of its file and its index
+                     in the file
+        )pbdoc");
+
+    corpus.def("build_opening_book", &sente::SGF::buildOpeningBook,
+        py::arg("paths"),
+        py::arg("filename"),
+        py::arg("depth") = 20,
+        py::arg("threads") = 0,
+        py::call_guard<py::gil_scoped_release>(),
+        R"pbdoc(
+            Builds an opening book from the first moves of a set of games and saves it to a file.
+
+            The games are replayed in parallel. Games that can't be loaded and games that start with handicap or other
+            setup stones (``AB`` or ``AW``) are skipped, as games are replayed from the empty board.
+
+            :param paths: the names of the SGF files
+            :param filename: the name of the file to save the book to
+            :param depth: the number of moves from the start of each game to add to the book
+            :param threads: the number of threads to replay the games with (0 uses one thread per CPU core)
+            :return: the number of (position, move) entries in the book
+            :raises OSError: If the book can't be saved (an existing book is left unchanged)
+        )pbdoc");
+
+    py::class_<sente::SGF::OpeningBook>(corpus, "OpeningBook", R"pbdoc(
+            An opening book built by ``sente.corpus.build_opening_book``.
+
+            The book file is memory mapped, so opening a book is instant and a lookup only reads a few pages of it.
+            Rotations and reflections of a position share their statistics.
+        )pbdoc")
+        .def(py::init<const std::string&>(),
+            py::arg("filename"),
+            R"pbdoc(
+                Opens an opening book.
+
+                :param filename: the name of the book file
+            )pbdoc")
+        .def("__len__", &sente::SGF::OpeningBook::size)
+        .def("get_depth", &sente::SGF::OpeningBook::getDepth,
+            R"pbdoc(
+                :return: the number of moves from the start of each game that are in the book
+            )pbdoc")
+        .def("lookup", [](const sente::SGF::OpeningBook& book, const sente::GoGame& game){
+
+                py::list result;
+
+                for (const auto& move : book.lookup(game)){
+                    py::dict statistics;
+                    statistics["move"] = move.move;
+                    statistics["count"] = move.count;
+                    statistics["wins"] = move.wins;
+                    statistics["losses"] = move.losses;
+                    if (move.wins + move.losses == 0){
+                        statistics["win_rate"] = py::none();
+                    }
+                    else {
+                        statistics["win_rate"] = double(move.wins) / double(move.wins + move.losses);
+                    }
+                    result.append(statistics);
+                }
+
+                return result;
+
+            },
+            py::arg("game"),
+            R"pbdoc(
+                Finds the moves that were played from the current position of a game.
+
+                :param game: the game to look up
+                :return: a list of dictionaries with the "move", its "count", the "wins" and "losses" of the player
+                         who played it and its "win_rate" (None if none of the games had a result), the most played
+                         moves first
+            )pbdoc");
+
+    corpus.def("build_position_index", &sente::SGF::buildPositionIndex,
+        py::arg("paths"),
+        py::arg("filename"),
+        py::arg("threads") = 0,
+        py::call_guard<py::gil_scoped_release>(),
+        R"pbdoc(
+            Builds a position index of a set of SGF files and saves it to a file.
+
+            The main line of every game is replayed (in parallel) and every position, as well as every corner of every
+            position, is added to the index. Games that can't be loaded and games that start with handicap or other setup
+            stones (``AB`` or ``AW``) are skipped, as games are replayed from the empty board.
+
+            :param paths: the names of the SGF files
+            :param filename: the name of the file to save the index to
+            :param threads: the number of threads to replay the games with (0 uses one thread per CPU core)
+            :return: the number of games in the files
+            :raises OSError: If the index can't be saved (an existing index is left unchanged)
+        )pbdoc");
+
+    py::class_<sente::SGF::PositionIndex>(corpus, "PositionIndex", R"pbdoc(
+            A position index built by ``sente.corpus.build_position_index``.
+
+            The index file is memory mapped, so opening an index is instant and a search only reads a few pages of it.
+            Positions match in any orientation and with the colors of the stones swapped.
+        )pbdoc")
+        .def(py::init<const std::string&>(),
+            py::arg("filename"),
+            R"pbdoc(
+                Opens a position index.
+
+                :param filename: the name of the index file
+            )pbdoc")
+        .def("__len__", &sente::SGF::PositionIndex::size)
+        .def("search", [](const sente::SGF::PositionIndex& index, const sente::GoGame& game, bool corners){
+
+                py::list result;
+
+                for (const auto& match : index.search(game, corners)){
+                    result.append(py::make_tuple(index.getFileName(match.file), match.game, match.move));
+                }
+
+                return result;
+
+            },
+            py::arg("game"),
+            py::arg("corners") = false,
+            R"pbdoc(
+                Finds every game in which the current position of a game occurred.
+
+                :param game: the game whose position to search for
+                :param corners: whether to search for each corner of the position (that has stones in it) in the
+                                corners of the indexed games rather than for the whole board
+                :return: a list of tuples of the name of the file, the index of the game in the file and the number of
+                         moves that had been played when the position first occurred
+            )pbdoc");
+
+    corpus.def("build_catalog", &sente::SGF::buildCatalog,
+        py::arg("paths"),
+        py::arg("filename"),
+        py::arg("threads") = 0,
+        py::call_guard<py::gil_scoped_release>(),
+        R"pbdoc(
+            Builds a catalog of the root properties (PB, PW, BR, WR, DT, EV, RE, KM, RU, HA and SZ) of every game in a
+            set of SGF files and saves it to a file.
+
+            Only the root node of each game is parsed. Files that can't be split into games are left out.
+
+            :param paths: the names of the SGF files
+            :param filename: the name of the file to save the catalog to
+            :param threads: the number of threads to read the files with (0 uses one thread per CPU core)
+            :return: the number of games in the catalog
+            :raises OSError: If the catalog can't be saved (an existing catalog is left unchanged)
+        )pbdoc");
+
+    py::class_<sente::SGF::Catalog>(corpus, "Catalog", R"pbdoc(
+            A catalog built by ``sente.corpus.build_catalog``.
+
+            Games are identified by their index in the catalog, which follows the order of the files (and of the games
+            within each file).
+        )pbdoc")
+        .def(py::init<const std::string&>(),
+            py::arg("filename"),
+            R"pbdoc(
+                Opens a catalog.
+
+                :param filename: the name of the catalog file
+            )pbdoc")
+        .def("__len__", &sente::SGF::Catalog::size)
+        .def("query", [](const sente::SGF::Catalog& catalog,
+                         const std::optional<std::string>& player, const std::optional<std::string>& black,
+                         const std::optional<std::string>& white, const std::optional<std::string>& event,
+                         const std::optional<std::string>& rules, const std::optional<std::string>& winner,
+                         const std::optional<std::string>& dateFrom, const std::optional<std::string>& dateTo,
+                         std::optional<float> komi, std::optional<unsigned> handicap, std::optional<unsigned> size){
+
+                sente::SGF::CatalogQuery query{player, black, white, event, rules, std::nullopt, dateFrom, dateTo,
+                                               komi, handicap, size};
+
+                if (winner){
+                    if (*winner != "B" and *winner != "W"){
+                        throw py::value_error("the winner must be \"B\" or \"W\"");
+                    }
+                    query.winner = (*winner)[0];
+                }
+
+                py::gil_scoped_release release;
+                return catalog.query(query);
+
+            },
+            py::arg("player") = py::none(),
+            py::arg("black") = py::none(),
+            py::arg("white") = py::none(),
+            py::arg("event") = py::none(),
+            py::arg("rules") = py::none(),
+            py::arg("winner") = py::none(),
+            py::arg("date_from") = py::none(),
+            py::arg("date_to") = py::none(),
+            py::arg("komi") = py::none(),
+            py::arg("handicap") = py::none(),
+            py::arg("size") = py::none(),
+            R"pbdoc(
+                Finds the games that match every filter that is given.
+
+                :param player: the name of either player (PB or PW)
+                :param black: the name of the black player
+                :param white: the name of the white player
+                :param event: the event (EV)
+                :param rules: the ruleset (RU)
+                :param winner: the color that won the game, "B" or "W"
+                :param date_from: the earliest date (DT) of the game, ie. "2015" or "2015-06-01"
+                :param date_to: the latest date of the game (inclusive, so "2015" includes the whole year)
+                :param komi: the komi (KM)
+                :param handicap: the number of handicap stones (HA)
+                :param size: the size of the board (SZ)
+                :return: a list of the indices of the matching games
+            )pbdoc")
+        .def("get_location", [](const sente::SGF::Catalog& catalog, size_t index){
+                auto location = catalog.getLocation(index);
+                return py::make_tuple(catalog.getFileName(location.file), location.game, location.offset,
+                                      location.length);
+            },
+            py::arg("index"),
+            R"pbdoc(
+                Finds where a game is stored.
+
+                :param index: the index of the game in the catalog
+                :return: a tuple of the name of the file, the index of the game in the file and the offset and length
+                         of the game in the (decompressed) text of the file
+            )pbdoc")
+        .def("get_properties", &sente::SGF::Catalog::getProperties,
+            py::arg("index"),
+            R"pbdoc(
+                Gets the catalogued root properties of a game.
+
+                :param index: the index of the game in the catalog
+                :return: a dictionary mapping property names to values for the catalogued properties that the game has
+            )pbdoc");
+
+    py::class_<sente::SGF::DataLoader>(corpus, "DataLoader", R"pbdoc(
+            An endless iterator of batches of positions sampled at random from the main lines of a set of SGF files.
+
+            The moves of every game are loaded once. After that, worker threads pick positions uniformly at random,
+            replay each game up to its position, apply a random symmetry of the board and write the features into a
+            batch. A few batches are always kept ready, so taking a batch usually doesn't have to wait.
+
+            Each batch is a tuple of a ``batch_size x features x side x side`` array of features, an array of the moves
+            that were played from the positions (encoded as ``x * side + y``, with ``side * side`` for a pass) and an
+            array of the results of the games (1 if the player to move won, -1 if they lost and 0 if the result isn't
+            known). Games that can't be loaded, games of other board sizes and games that start with handicap or other
+            setup stones (``AB`` or ``AW``) are left out, as games are replayed from the empty board.
+        )pbdoc")
+        .def(py::init([](const std::vector<std::string>& fileNames, size_t batchSize,
+                         const std::vector<std::string>& features, unsigned side, unsigned threads, size_t prefetch,
+                         std::optional<uint64_t> seed){
+
+                auto featureVector = sente::utils::parseFeatures(features);
+
+                if (not seed){
+                    std::random_device device;
+                    seed = (uint64_t(device()) << 32) | device();
+                }
+
+                py::gil_scoped_release release;
+                return std::make_unique<sente::SGF::DataLoader>(fileNames, batchSize, featureVector, side, threads,
+                                                                prefetch, *seed);
+            }),
+            py::arg("filenames"),
+            py::arg("batch_size"),
+            py::arg("features") = std::vector<std::string>{"black_stones", "white_stones", "empty_points",
+                                                          "ko_points"},
+            py::arg("side") = 19,
+            py::arg("threads") = 0,
+            py::arg("prefetch") = 4,
+            py::arg("seed") = py::none(),
+            R"pbdoc(
+                Loads the games and starts the worker threads.
+
+                :param filenames: the names of the SGF files (which may be collections)
+                :param batch_size: the number of positions in each batch
+                :param features: the names of the features to include (ie. ``["black_stones", "white_stones"]``)
+                :param side: the size of the board (games of other sizes are left out)
+                :param threads: the number of threads to load the games and fill the batches with (0 uses one thread
+                                per CPU core)
+                :param prefetch: the number of batches to keep ready
+                :param seed: the seed of the random number generators (batches are filled by several threads, so the
+                             order of the batches may still change from run to run)
+            )pbdoc")
+        .def("__iter__", [](sente::SGF::DataLoader& loader) -> sente::SGF::DataLoader& {
+                return loader;
+            })
+        .def("__next__", [](sente::SGF::DataLoader& loader){
+
+                sente::SGF::Batch batch;
+                {
+                    py::gil_scoped_release release;
+                    batch = loader.next();
+                }
+
+                size_t size = loader.getBatchSize();
+                size_t side = loader.getSide();
+
+                return py::make_tuple(
+                    toArray<uint8_t>(std::move(batch.features), {size, loader.getFeatureCount(), side, side}),
+                    toArray<int32_t>(std::move(batch.moves), {size}),
+                    toArray<float>(std::move(batch.values), {size}));
+            })
+        .def("get_game_count", &sente::SGF::DataLoader::getGameCount,
+            R"pbdoc(
+                Gets the number of games that positions are sampled from.
+
+                :return: the number of games
+            )pbdoc")
+        .def("get_position_count", &sente::SGF::DataLoader::getPositionCount,
+            R"pbdoc(
+                Gets the number of positions that may be sampled.
+
+                :return: the number of positions
+            )pbdoc");
 
     auto exceptions = module.def_submodule("exceptions", "various exceptions used by sente");
 
@@ -693,8 +1574,10 @@ PYBIND11_MODULE(sente, module){
 
 #if PY_MAJOR_VERSION == 3
     py::register_exception<sente::utils::FileNotFoundException>(exceptions, "FileNotFoundError", PyExc_FileNotFoundError);
+    py::register_exception<sente::utils::FileWriteException>(exceptions, "FileWriteError", PyExc_OSError);
 #else
     py::register_exception<sente::utils::FileNotFoundException>(exceptions, "IOError", PyExc_IOError);
+    py::register_exception<sente::utils::FileWriteException>(exceptions, "FileWriteError", PyExc_IOError);
 #endif
 
     auto GTP = module.def_submodule("GTP", R"pbdoc(
@@ -0,0 +1,617 @@
+"""
+
+Author: Arthur Wesley
+
+"""
+
+import os
+import struct
+import tempfile
+import zipfile
+from unittest import TestCase
+
+import numpy as np
+
+import sente
+from sente import sgf
+
+
+class LoadCollection(TestCase):
+
+    def test_load_collection(self):
+        """
+
+        tests to see if every game in a collection is loaded
+
+        :return:
+        """
+
+        games = sgf.load_collection("tests/sgf collections/three games.sgf")
+
+        self.assertEqual(3, len(games))
+
+        self.assertEqual("Black 1", games[0].get_properties()["PB"])
+        self.assertEqual("Black 2", games[1].get_properties()["PB"])
+        self.assertEqual("Black 3", games[2].get_properties()["PB"])
+
+    def test_collection_game_contents(self):
+        """
+
+        tests to see if the games in a collection contain the correct moves
+
+        :return:
+        """
+
+        games = sgf.load_collection("tests/sgf collections/three games.sgf")
+
+        self.assertEqual(4, len(games[0].get_default_sequence()))
+        self.assertEqual(2, len(games[1].get_all_sequences()))
+        self.assertEqual("9", games[1].get_properties()["SZ"])
+
+        games[2].play_default_sequence()
+        self.assertEqual(sente.stone.WHITE, games[2].get_point(4, 3))
+
+    def test_thread_counts_agree(self):
+        """
+
+        tests to see if the number of threads does not change the result
+
+        :return:
+        """
+
+        serial = sgf.load_collection("tests/sgf collections/three games.sgf", threads=1)
+        parallel = sgf.load_collection("tests/sgf collections/three games.sgf", threads=4)
+
+        self.assertEqual([game.get_all_sequences() for game in serial],
+                         [game.get_all_sequences() for game in parallel])
+
+    def test_single_game_collection(self):
+        """
+
+        tests to see if a regular SGF file can be loaded as a collection of one game
+
+        :return:
+        """
+
+        games = sgf.load_collection("tests/sgf/simple fork.sgf")
+
+        self.assertEqual(1, len(games))
+
+    def test_invalid_collection(self):
+        """
+
+        tests to see if an invalid game in a collection raises an exception
+
+        :return:
+        """
+
+        with self.assertRaises(sente.exceptions.InvalidSGFException):
+            sgf.load_collection("tests/invalid sgf/extra letter in move.sgf")
+
+    def test_nonexistent_file(self):
+        """
+
+        tests to see if loading a collection that does not exist raises an exception
+
+        :return:
+        """
+
+        with self.assertRaises(FileNotFoundError):
+            sgf.load_collection("tests/sgf collections/nonexistent file.sgf")
+
+
+class LoadMany(TestCase):
+
+    files = ["tests/sgf/simple sequence.sgf",
+             "tests/sgf/simple fork.sgf",
+             "tests/sgf/two josekis.sgf",
+             "tests/sgf/Lee Sedol ladder game.sgf"]
+
+    def test_load_many(self):
+        """
+
+        tests to see if loading several files gives the same games as loading them one at a time
+
+        :return:
+        """
+
+        games = sgf.load_many(self.files)
+
+        self.assertEqual(len(self.files), len(games))
+
+        for file, game in zip(self.files, games):
+            self.assertEqual(sgf.load(file).get_all_sequences(), game.get_all_sequences())
+
+    def test_thread_counts_agree(self):
+        """
+
+        tests to see if the number of threads does not change the result
+
+        :return:
+        """
+
+        serial = sgf.load_many(self.files, threads=1)
+        parallel = sgf.load_many(self.files, threads=4)
+
+        self.assertEqual([game.get_all_sequences() for game in serial],
+                         [game.get_all_sequences() for game in parallel])
+
+    def test_main_line_only(self):
+        """
+
+        tests to see if the main line only option is passed on to every file
+
+        :return:
+        """
+
+        games = sgf.load_many(self.files, main_line_only=True)
+
+        for game in games:
+            self.assertEqual(1, len(game.get_all_sequences()))
+
+    def test_intern_values(self):
+        """
+
+        tests to see if interning property values does not change the games
+
+        :return:
+        """
+
+        games = sgf.load_many(self.files, intern_values=True)
+
+        for file, game in zip(self.files, games):
+            plain = sgf.load(file)
+            self.assertEqual(plain.get_properties(), game.get_properties())
+            self.assertEqual(plain.get_all_sequences(), game.get_all_sequences())
+
+        self.assertGreater(sgf.interned_values(), 0)
+
+    def test_release_interned_values(self):
+        """
+
+        tests to see if values are freed once the games that used them are gone
+
+        :return:
+        """
+
+        games = sgf.load_many(self.files, intern_values=True)
+        sgf.release_interned_values()
+        count = sgf.interned_values()
+
+        del games
+
+        self.assertGreater(sgf.release_interned_values(), 0)
+        self.assertLess(sgf.interned_values(), count)
+
+    def test_empty_list(self):
+        """
+
+        tests to see if loading no files gives no games
+
+        :return:
+        """
+
+        self.assertEqual([], sgf.load_many([]))
+
+    def test_missing_file(self):
+        """
+
+        tests to see if a missing file in the list raises an exception
+
+        :return:
+        """
+
+        with self.assertRaises(FileNotFoundError):
+            sgf.load_many(["tests/sgf/simple fork.sgf", "tests/sgf/nonexistent file.sgf"])
+
+    def test_warnings_name_file(self):
+        """
+
+        tests to see if warnings from a batch of files say which file they came from
+
+        :return:
+        """
+
+        with self.assertWarnsRegex(Warning, r'\(tests/warning sgf/Jappanese Date \(JD\) property.sgf, line 7, column 1\)'):
+            sgf.load_many(["tests/sgf/simple fork.sgf", "tests/warning sgf/Jappanese Date (JD) property.sgf"],
+                          threads=2)
+
+
+class IndexedCollection(TestCase):
+
+    def setUp(self):
+        """
+
+        keeps the index files out of the test directory
+
+        :return:
+        """
+
+        self.directory = tempfile.TemporaryDirectory()
+        self.index = os.path.join(self.directory.name, "three games.index")
+
+    def tearDown(self):
+        self.directory.cleanup()
+
+    def test_random_access(self):
+        """
+
+        tests to see if games can be loaded out of order from an indexed collection
+
+        :return:
+        """
+
+        collection = sgf.Collection("tests/sgf collections/three games.sgf", index_filename=self.index)
+
+        self.assertEqual(3, len(collection))
+        self.assertEqual("9", collection[1].get_properties()["SZ"])
+        self.assertEqual("Black 3", collection[-1].get_properties()["PB"])
+        self.assertEqual("Black 1", collection.load(0).get_properties()["PB"])
+
+        with self.assertRaises(IndexError):
+            collection[3]
+
+    def test_indexed_properties(self):
+        """
+
+        tests to see if the root properties of a game can be read from the index
+
+        :return:
+        """
+
+        collection = sgf.Collection("tests/sgf collections/three games.sgf", index_filename=self.index)
+
+        properties = collection.get_properties(1)
+
+        self.assertEqual("Black 2", properties["PB"])
+        self.assertEqual("White 2", properties["PW"])
+        self.assertEqual("9", properties["SZ"])
+
+    def test_index_is_reused(self):
+        """
+
+        tests to see if an index built ahead of time gives the same games
+
+        :return:
+        """
+
+        self.assertEqual(3, sgf.build_index("tests/sgf collections/three games.sgf", index_filename=self.index))
+        self.assertTrue(os.path.exists(self.index))
+
+        collection = sgf.Collection("tests/sgf collections/three games.sgf", index_filename=self.index)
+        games = sgf.load_collection("tests/sgf collections/three games.sgf")
+
+        self.assertEqual([game.get_all_sequences() for game in games],
+                         [collection[i].get_all_sequences() for i in range(len(collection))])
+
+    def test_edited_collection(self):
+        """
+
+        tests to see if the index is rebuilt when the collection is edited without changing its size
+
+        :return:
+        """
+
+        path = os.path.join(self.directory.name, "three games.sgf")
+        with open("tests/sgf collections/three games.sgf") as file:
+            text = file.read()
+        with open(path, "w") as file:
+            file.write(text)
+
+        self.assertEqual("Black 2", sgf.Collection(path, index_filename=self.index).get_properties(1)["PB"])
+
+        # keep the modification time so that only the contents give the edit away
+        times = os.stat(path)
+        with open(path, "w") as file:
+            file.write(text.replace("Black 2", "Blake 2"))
+        os.utime(path, ns=(times.st_atime_ns, times.st_mtime_ns))
+
+        collection = sgf.Collection(path, index_filename=self.index)
+
+        self.assertEqual("Blake 2", collection.get_properties(1)["PB"])
+        self.assertEqual("Blake 2", collection[1].get_properties()["PB"])
+
+        # no temporary files are left behind
+        self.assertEqual(["three games.index", "three games.sgf"], sorted(os.listdir(self.directory.name)))
+
+
+class LoadZip(TestCase):
+
+    files = ["simple sequence.sgf", "simple fork.sgf", "two josekis.sgf", "Lee Sedol ladder game.sgf"]
+
+    def setUp(self):
+        """
+
+        makes an archive of some SGF files (with both stored and deflated files)
+
+        :return:
+        """
+
+        self.directory = tempfile.TemporaryDirectory()
+        self.archive = os.path.join(self.directory.name, "games.zip")
+
+        with zipfile.ZipFile(self.archive, "w") as archive:
+            archive.writestr("games/", "")
+            for i, file in enumerate(self.files):
+                archive.write(os.path.join("tests/sgf", file), "games/" + file,
+                              compress_type=zipfile.ZIP_DEFLATED if i % 2 else zipfile.ZIP_STORED)
+            archive.writestr("readme.txt", "not an SGF file")
+
+    def tearDown(self):
+        self.directory.cleanup()
+
+    def test_load_zip(self):
+        """
+
+        tests to see if every SGF file in an archive is loaded
+
+        :return:
+        """
+
+        games = sgf.load_zip(self.archive)
+
+        self.assertEqual(["games/" + file for file in self.files], list(games.keys()))
+
+        for file in self.files:
+            self.assertEqual(sgf.load(os.path.join("tests/sgf", file)).get_all_sequences(),
+                             games["games/" + file].get_all_sequences())
+
+    def test_thread_counts_agree(self):
+        """
+
+        tests to see if the number of threads does not change the result
+
+        :return:
+        """
+
+        serial = sgf.load_zip(self.archive, threads=1)
+        parallel = sgf.load_zip(self.archive, threads=4)
+
+        self.assertEqual({name: game.get_all_sequences() for name, game in serial.items()},
+                         {name: game.get_all_sequences() for name, game in parallel.items()})
+
+    def test_not_an_archive(self):
+        """
+
+        tests to see if loading something that isn't a ZIP archive raises an exception
+
+        :return:
+        """
+
+        with self.assertRaises(sente.exceptions.InvalidSGFException):
+            sgf.load_zip("tests/sgf/simple fork.sgf")
+
+    def test_impossible_size(self):
+        """
+
+        tests to see if an entry that claims to be far larger than it could decompress to raises an exception
+
+        :return:
+        """
+
+        with open(self.archive, "rb") as file:
+            data = bytearray(file.read())
+
+        # the last copy of the name is in the central directory, 46 bytes after the start of the entry's header
+        header = data.rindex(b"games/simple fork.sgf") - 46
+        self.assertEqual(b"PK\x01\x02", data[header:header + 4])
+
+        # the uncompressed size is 24 bytes into the header
+        data[header + 24:header + 28] = struct.pack("<I", 0x7FFFFFFF)
+
+        with open(self.archive, "wb") as file:
+            file.write(data)
+
+        with self.assertRaises(sente.exceptions.InvalidSGFException):
+            sgf.load_zip(self.archive)
+
+
+class LiveReader(TestCase):
+
+    def setUp(self):
+        """
+
+        keeps the file that is being written out of the test directory
+
+        :return:
+        """
+
+        self.directory = tempfile.TemporaryDirectory()
+        self.file = os.path.join(self.directory.name, "live.sgf")
+
+    def tearDown(self):
+        self.directory.cleanup()
+
+    def write(self, text, mode="w"):
+        with open(self.file, mode) as file:
+            file.write(text)
+
+    def test_appended_moves(self):
+        """
+
+        tests to see if moves that are appended to a file are added to the game
+
+        :return:
+        """
+
+        self.write("(;GM[1]FF[4]SZ[19]PB[Black]PW[White];B[dd]")
+        reader = sgf.LiveReader(self.file)
+
+        # the last node isn't added until the next one has started
+        self.assertEqual(0, len(reader.game.get_current_sequence()))
+        self.assertEqual("Black", reader.game.get_properties()["PB"])
+
+        self.write(";W[pp]", "a")
+        self.assertEqual(1, reader.update())
+        self.assertEqual(sente.stone.BLACK, reader.game.get_point(4, 4))
+
+        self.write(";B[dp])", "a")
+        self.assertEqual(2, reader.update())
+        self.assertEqual(sente.stone.WHITE, reader.game.get_point(16, 16))
+        self.assertEqual(sente.stone.BLACK, reader.game.get_point(4, 16))
+        self.assertEqual(0, reader.update())
+
+    def test_rewritten_end(self):
+        """
+
+        tests to see if a file whose closing parenthesis is rewritten after each move is followed
+
+        :return:
+        """
+
+        with open("tests/sgf/Lee Sedol ladder game.sgf") as file:
+            text = file.read()
+
+        body = text[:text.rindex(")")]
+        starts = [index for index, character in enumerate(body) if character == ";"] + [len(body)]
+
+        self.write(body[:starts[1]] + ")")
+        reader = sgf.LiveReader(self.file)
+
+        for start in starts[2:]:
+            self.write(body[:start] + ")\n")
+            reader.update()
+
+        expected = sgf.loads(text)
+        expected.play_default_sequence()
+
+        self.assertEqual(expected.get_current_sequence(), reader.game.get_current_sequence())
+
+    def test_rewritten_file(self):
+        """
+
+        tests to see if the game is read again when the text that was already read changes
+
+        :return:
+        """
+
+        self.write("(;GM[1]SZ[19];B[dd];W[pp])")
+        reader = sgf.LiveReader(self.file)
+        self.assertEqual(2, len(reader.game.get_current_sequence()))
+
+        self.write("(;GM[1]SZ[9];B[ee])")
+        reader.update()
+
+        self.assertEqual(9, reader.game.get_board().get_side())
+        self.assertEqual(1, len(reader.game.get_current_sequence()))
+        self.assertEqual(sente.stone.BLACK, reader.game.get_point(5, 5))
+
+    def test_variations(self):
+        """
+
+        tests to see if variations are added to the game tree without moving the board off the main line
+
+        :return:
+        """
+
+        self.write("(;GM[1]SZ[9];B[ee](;W[cc];B[gg])(;W[gc]")
+        reader = sgf.LiveReader(self.file)
+
+        self.write("))", "a")
+        reader.update()
+
+        self.assertEqual(3, len(reader.game.get_current_sequence()))
+
+        reader.game.advance_to_root()
+        self.assertEqual(2, len(reader.game.get_all_sequences()))
+
+
+class Positions(TestCase):
+
+    def test_positions_match_replay(self):
+        """
+
+        tests to see if the positions of a game are the same as the positions of the game when it is played out
+
+        :return:
+        """
+
+        moves = sgf.load("tests/sgf/Lee Sedol ladder game.sgf").get_default_sequence()
+        game = sente.Game()
+
+        positions = list(sgf.positions("tests/sgf/Lee Sedol ladder game.sgf", features=["black_stones", "white_stones"]))
+
+        self.assertEqual(len(moves), len(positions))
+
+        for i, (move_number, features, next_move, result) in enumerate(positions):
+            self.assertEqual(i, move_number)
+            self.assertTrue(np.array_equal(game.numpy(["black_stones", "white_stones"]), features))
+            self.assertEqual(moves[i], next_move)
+            self.assertEqual("B+R", result)
+            game.play(next_move)
+
+    def test_every(self):
+        """
+
+        tests to see if only every few positions are yielded and that boards are yielded without features
+
+        :return:
+        """
+
+        positions = list(sgf.positions("tests/sgf/Lee Sedol ladder game.sgf", every=10))
+
+        self.assertEqual(list(range(0, 211, 10)), [move_number for move_number, _, _, _ in positions])
+        self.assertEqual(19, positions[1][1].get_side())
+        self.assertEqual(10, sum(positions[1][1].get_stone(x, y) != sente.stone.EMPTY
+                                 for x in range(1, 20) for y in range(1, 20)))
+
+    def test_collections(self):
+        """
+
+        tests to see if the positions of every game of every file are yielded
+
+        :return:
+        """
+
+        positions = list(sgf.positions(["tests/sgf collections/three games.sgf", "tests/sgf/simple sequence.sgf"]))
+        results = [result for _, _, _, result in positions]
+
+        self.assertEqual(["B+R"] * 4 + ["W+3.5"] * 3 + [""] * 2, results[:9])
+        self.assertEqual(len(sgf.load("tests/sgf/simple sequence.sgf").get_default_sequence()), len(positions) - 9)
+
+    def test_handicap_games(self):
+        """
+
+        tests to see if games with handicap stones are skipped
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "handicap.sgf")
+            with open(path, "w") as file:
+                file.write("(;GM[1]FF[4]SZ[19]HA[2]AB[dd][pp]RE[W+R];W[pd];B[dp])(;GM[1]FF[4]SZ[19]RE[B+R];B[pd])")
+
+            positions = list(sgf.positions(path))
+
+        self.assertEqual([(0, "B+R")], [(move_number, result) for move_number, _, _, result in positions])
+
+    def test_stopping_early(self):
+        """
+
+        tests to see if an iterator can be dropped before the background thread has replayed every game
+
+        :return:
+        """
+
+        for _ in range(10):
+            positions = sgf.positions("tests/sgf/Lee Sedol ladder game.sgf", queue_size=1)
+            self.assertEqual(0, next(positions)[0])
+            del positions
+
+    def test_errors(self):
+        """
+
+        tests to see if missing files and unknown features raise exceptions
+
+        :return:
+        """
+
+        with self.assertRaises(FileNotFoundError):
+            list(sgf.positions(["tests/sgf/simple sequence.sgf", "tests/sgf/no such file.sgf"]))
+
+        with self.assertRaises(ValueError):
+            sgf.positions("tests/sgf/simple sequence.sgf", features=["liberties"])
+
+        with self.assertRaises(ValueError):
+            sgf.positions("tests/sgf/simple sequence.sgf", every=0)
@@ -0,0 +1,733 @@
+"""
+
+Author: Arthur Wesley
+
+"""
+
+import os
+import gzip
+import re
+import tempfile
+from unittest import TestCase
+
+import numpy as np
+
+import sente
+from sente import sgf, corpus
+
+
+class CorpusStats(TestCase):
+
+    def test_collection_stats(self):
+        """
+
+        tests to see if every game in a collection is counted
+
+        :return:
+        """
+
+        stats = corpus.stats(["tests/sgf collections/three games.sgf"])
+
+        self.assertEqual(3, stats["games"])
+        self.assertEqual(0, stats["invalid_files"])
+        self.assertEqual({19: 2, 9: 1}, stats["board_sizes"])
+        self.assertEqual({"B+R": 1, "W+": 1}, stats["results"])
+        self.assertEqual({"Black 1": 1, "White 1": 1, "Black 2": 1, "White 2": 1, "Black 3": 1, "White 3": 1},
+                         stats["players"])
+        self.assertEqual({}, stats["unknown_properties"])
+
+    def test_main_line_move_counts(self):
+        """
+
+        tests to see if only the moves of the main line are counted
+
+        :return:
+        """
+
+        stats = corpus.stats(["tests/sgf collections/three games.sgf", "tests/sgf/Lee Sedol ladder game.sgf"])
+
+        self.assertEqual({4: 1, 3: 1, 2: 1, 211: 1}, stats["move_counts"])
+
+    def test_unknown_properties(self):
+        """
+
+        tests to see if unknown properties are counted
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "unknown.sgf")
+            with open(path, "w") as file:
+                file.write("(;GM[1]FF[4]XX[1]RE[w+resign];B[aa]XX[2]YY[3](;W[bb])(;W[cc]ZZ[4]))")
+
+            stats = corpus.stats([path])
+
+        self.assertEqual({"XX": 2, "YY": 1, "ZZ": 1}, stats["unknown_properties"])
+        self.assertEqual({"W+R": 1}, stats["results"])
+        self.assertEqual({2: 1}, stats["move_counts"])
+
+    def test_invalid_files(self):
+        """
+
+        tests to see if files that aren't SGF files are counted rather than stopping the scan
+
+        :return:
+        """
+
+        stats = corpus.stats(["tests/invalid sgf/empty file.txt", "tests/sgf/3-4.sgf"])
+
+        self.assertEqual(1, stats["invalid_files"])
+        self.assertEqual(1, stats["games"])
+
+    def test_unreadable_files(self):
+        """
+
+        tests to see if missing and corrupt gzip files are counted rather than stopping the scan
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "truncated.sgf.gz")
+            with open("tests/sgf/Lee Sedol ladder game.sgf", "rb") as file:
+                compressed = gzip.compress(file.read())
+            with open(path, "wb") as file:
+                file.write(compressed[:len(compressed) // 2])
+
+            stats = corpus.stats([path, os.path.join(directory, "missing.sgf"), "tests/sgf/3-4.sgf"])
+
+        self.assertEqual(2, stats["invalid_files"])
+        self.assertEqual(1, stats["games"])
+
+    def test_thread_counts_agree(self):
+        """
+
+        tests to see if the number of threads does not change the result
+
+        :return:
+        """
+
+        paths = [os.path.join("tests/sgf", name) for name in sorted(os.listdir("tests/sgf"))]
+
+        self.assertEqual(corpus.stats(paths, threads=1), corpus.stats(paths, threads=4))
+
+
+class Duplicates(TestCase):
+
+    @staticmethod
+    def transpose(sgf_text):
+        """
+
+        reflects the moves of a game across the main diagonal
+
+        :param sgf_text: text of the game
+        :return: the text of the reflected game
+        """
+
+        return re.sub(r";([BW])\[([a-s])([a-s])\]", r";\1[\3\2]", sgf_text)
+
+    def test_copies_are_duplicates(self):
+        """
+
+        tests to see if copies of a game with different metadata are found
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "copy.sgf")
+            with open("tests/sgf/Lee Sedol ladder game.sgf") as file:
+                text = file.read()
+            with open(path, "w") as file:
+                file.write(text.replace("PB[", "C[downloaded from another server]PB["))
+
+            clusters = corpus.duplicates(["tests/sgf/Lee Sedol ladder game.sgf", path])
+
+        self.assertEqual([[("tests/sgf/Lee Sedol ladder game.sgf", 0), (path, 0)]], clusters)
+
+    def test_symmetries_are_duplicates(self):
+        """
+
+        tests to see if reflected games in a collection are found
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "reflected.sgf")
+            with open("tests/sgf collections/three games.sgf") as file:
+                text = file.read()
+            with open(path, "w") as file:
+                file.write(self.transpose(text))
+
+            clusters = corpus.duplicates(["tests/sgf collections/three games.sgf", path])
+
+        self.assertEqual(3, len(clusters))
+        self.assertIn([("tests/sgf collections/three games.sgf", 2), (path, 2)], clusters)
+
+    def test_different_games(self):
+        """
+
+        tests to see if different games are not reported as duplicates
+
+        :return:
+        """
+
+        clusters = corpus.duplicates(["tests/sgf/Lee Sedol ladder game.sgf", "tests/sgf/Ear-reddening game.sgf",
+                                      "tests/sgf collections/three games.sgf"])
+
+        self.assertEqual([], clusters)
+
+    def test_setup_stones(self):
+        """
+
+        tests to see if games with the same moves are only duplicates if they have the same handicap stones
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "handicap.sgf")
+            with open(path, "w") as file:
+                file.write("(;GM[1]FF[4]SZ[19]HA[2]AB[dd][pp];W[qq];B[cc])"
+                           "(;GM[1]FF[4]SZ[19]HA[2]AB[dp][pd];W[qq];B[cc])"
+                           "(;GM[1]FF[4]SZ[19]HA[2]AB[pp][dd];W[qq];B[cc])")
+
+            clusters = corpus.duplicates([path])
+
+        self.assertEqual([[(path, 0), (path, 2)]], clusters)
+
+    def test_unreadable_files(self):
+        """
+
+        tests to see if missing files are skipped rather than stopping the search
+
+        :return:
+        """
+
+        clusters = corpus.duplicates(["tests/sgf/nonexistent file.sgf", "tests/sgf collections/three games.sgf",
+                                      "tests/sgf collections/three games.sgf"])
+
+        self.assertEqual(3, len(clusters))
+
+    def test_min_moves(self):
+        """
+
+        tests to see if short games can be ignored
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "copy.sgf")
+            with open("tests/sgf collections/three games.sgf") as file:
+                text = file.read()
+            with open(path, "w") as file:
+                file.write(text)
+
+            paths = ["tests/sgf collections/three games.sgf", path]
+
+            self.assertEqual(3, len(corpus.duplicates(paths)))
+            self.assertEqual(1, len(corpus.duplicates(paths, min_moves=4)))
+
+
+class OpeningBook(TestCase):
+
+    games = ["(;GM[1]FF[4]SZ[19]RE[B+R];B[pd];W[dp];B[pp])",
+             "(;GM[1]FF[4]SZ[19]RE[W+2.5];B[dp];W[pd])",
+             "(;GM[1]FF[4]SZ[19]RE[B+3.5];B[cd])",
+             "(;GM[1]FF[4]SZ[19]AB[dd][pp];W[pd])"]
+
+    def build_book(self, directory, depth=20):
+        """
+
+        builds a book out of the test games
+
+        :param directory: directory to save the games and the book in
+        :param depth: depth of the book
+        :return: the book
+        """
+
+        paths = []
+        for i, game in enumerate(self.games):
+            paths.append(os.path.join(directory, str(i) + ".sgf"))
+            with open(paths[-1], "w") as file:
+                file.write(game)
+
+        book_path = os.path.join(directory, "openings.book")
+        corpus.build_opening_book(paths, book_path, depth=depth, threads=2)
+        return corpus.OpeningBook(book_path)
+
+    def test_empty_board(self):
+        """
+
+        tests to see if symmetric opening moves are counted together
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            book = self.build_book(directory)
+
+            moves = book.lookup(sente.Game())
+
+        # the handicap game is skipped
+        self.assertEqual([2, 1], [move["count"] for move in moves])
+        self.assertEqual(1, moves[0]["wins"])
+        self.assertEqual(1, moves[0]["losses"])
+        self.assertEqual(0.5, moves[0]["win_rate"])
+        self.assertEqual(1.0, moves[1]["win_rate"])
+
+    def test_symmetric_positions(self):
+        """
+
+        tests to see if the moves of a reflected position are returned in the orientation of the game
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            book = self.build_book(directory)
+
+            game = sgf.loads(self.games[0])
+            first, second, _ = game.get_default_sequence()
+            game.play(first)
+
+            moves = book.lookup(game)
+
+        self.assertEqual(1, len(moves))
+        self.assertEqual(second, moves[0]["move"])
+        self.assertEqual(2, moves[0]["count"])
+
+    def test_depth(self):
+        """
+
+        tests to see if only the first moves of each game are added
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            book = self.build_book(directory, depth=1)
+
+            game = sgf.loads(self.games[0])
+            game.play(game.get_default_sequence()[0])
+
+            self.assertEqual(1, book.get_depth())
+            self.assertEqual(2, len(book))
+            self.assertEqual([], book.lookup(game))
+
+    def test_unreadable_files(self):
+        """
+
+        tests to see if missing files are left out rather than stopping the build
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            book_path = os.path.join(directory, "openings.book")
+            corpus.build_opening_book([os.path.join(directory, "missing.sgf"), "tests/sgf/3-4.sgf"], book_path,
+                                      depth=1)
+
+            self.assertEqual(1, len(corpus.OpeningBook(book_path)))
+
+    def test_write_error(self):
+        """
+
+        tests to see if a book that can't be saved raises an exception and that rebuilding a book replaces it
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            with self.assertRaises(OSError):
+                corpus.build_opening_book(["tests/sgf/3-4.sgf"], os.path.join(directory, "missing", "openings.book"))
+
+            book_path = os.path.join(directory, "openings.book")
+            corpus.build_opening_book(["tests/sgf/3-4.sgf"], book_path, depth=1)
+            corpus.build_opening_book(["tests/sgf/3-4.sgf"], book_path, depth=2)
+
+            self.assertEqual(2, corpus.OpeningBook(book_path).get_depth())
+            # no temporary files are left behind
+            self.assertEqual(["openings.book"], os.listdir(directory))
+
+    def test_invalid_book(self):
+        """
+
+        tests to see if opening a file that isn't a book raises an exception
+
+        :return:
+        """
+
+        with self.assertRaises(sente.exceptions.InvalidSGFException):
+            corpus.OpeningBook("tests/sgf/3-4.sgf")
+
+
+class PositionIndex(TestCase):
+
+    paths = ["tests/sgf/Lee Sedol ladder game.sgf", "tests/sgf/Ear-reddening game.sgf",
+             "tests/sgf collections/three games.sgf"]
+
+    def test_whole_board(self):
+        """
+
+        tests to see if the games that a position occurred in are found
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "positions.index")
+            self.assertEqual(5, corpus.build_position_index(self.paths, path, threads=2))
+            index = corpus.PositionIndex(path)
+
+            game = sgf.load("tests/sgf/Lee Sedol ladder game.sgf")
+            for move in game.get_default_sequence()[:30]:
+                game.play(move)
+
+            self.assertEqual(5, len(index))
+            self.assertEqual([("tests/sgf/Lee Sedol ladder game.sgf", 0, 30)], index.search(game))
+
+    def test_symmetry_and_color_swap(self):
+        """
+
+        tests to see if reflected positions with the colors swapped are found
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "positions.index")
+            corpus.build_position_index(self.paths, path)
+            index = corpus.PositionIndex(path)
+
+            moves = sgf.load("tests/sgf/Lee Sedol ladder game.sgf").get_default_sequence()[:10]
+
+            # white plays black's moves (reflected across the diagonal) and vice versa
+            game = sente.Game()
+            game.pss()
+            for move in moves:
+                game.play(sente.Move(move.get_y(), move.get_x(), sente.opposite_player(move.get_stone())))
+
+            self.assertEqual([("tests/sgf/Lee Sedol ladder game.sgf", 0, 10)], index.search(game))
+
+    def test_corners(self):
+        """
+
+        tests to see if a corner pattern is found in every game it occurred in
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "positions.index")
+            corpus.build_position_index(self.paths, path)
+            index = corpus.PositionIndex(path)
+
+            # a 4-4 stone in one corner and a 3-4 stone in another, which never happened in the same game
+            game = sente.Game()
+            game.play(sente.Move(15, 3, sente.stone.BLACK))
+            game.play(sente.Move(2, 15, sente.stone.WHITE))
+
+            self.assertEqual([], index.search(game))
+            self.assertEqual([("tests/sgf/Lee Sedol ladder game.sgf", 0, 1),
+                              ("tests/sgf/Ear-reddening game.sgf", 0, 1),
+                              ("tests/sgf collections/three games.sgf", 0, 1),
+                              ("tests/sgf collections/three games.sgf", 2, 1)], index.search(game, corners=True))
+
+    def test_empty_board(self):
+        """
+
+        tests to see if searching for the empty board finds nothing
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "positions.index")
+            corpus.build_position_index(self.paths, path)
+
+            self.assertEqual([], corpus.PositionIndex(path).search(sente.Game()))
+
+    def test_unreadable_files(self):
+        """
+
+        tests to see if missing files are left out rather than stopping the build
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            path = os.path.join(directory, "positions.index")
+            self.assertEqual(5, corpus.build_position_index([os.path.join(directory, "missing.sgf")] + self.paths,
+                                                            path))
+            index = corpus.PositionIndex(path)
+
+            game = sgf.load("tests/sgf/Lee Sedol ladder game.sgf")
+            for move in game.get_default_sequence()[:30]:
+                game.play(move)
+
+            self.assertEqual([("tests/sgf/Lee Sedol ladder game.sgf", 0, 30)], index.search(game))
+
+    def test_write_error(self):
+        """
+
+        tests to see if an index that can't be saved raises an exception and that rebuilding an index replaces it
+
+        :return:
+        """
+
+        with tempfile.TemporaryDirectory() as directory:
+            with self.assertRaises(OSError):
+                corpus.build_position_index(self.paths, os.path.join(directory, "missing", "positions.index"))
+
+            path = os.path.join(directory, "positions.index")
+            corpus.build_position_index(self.paths, path)
+            corpus.build_position_index(["tests/sgf/3-4.sgf"], path)
+
+            self.assertEqual(1, len(corpus.PositionIndex(path)))
+            # no temporary files are left behind
+            self.assertEqual(["positions.index"], os.listdir(directory))
+
+    def test_invalid_index(self):
+        """
+
+        tests to see if opening a file that isn't an index raises an exception
+
+        :return:
+        """
+
+        with self.assertRaises(sente.exceptions.InvalidSGFException):
+            corpus.PositionIndex("tests/sgf/3-4.sgf")
+
+
+class Catalog(TestCase):
+
+    paths = ["tests/sgf/0.5 Komi.sgf", "tests/sgf/34839594-255-IDW64-noob_bot_3.sgf",
+             "tests/sgf/35166124-133-IDW64-amybot-ddk.sgf", "tests/sgf/CheongSu-hyeon-KimIl-hwan13651.sgf",
+             "tests/sgf/Ear-reddening game.sgf", "tests/sgf/Lee Sedol ladder game.sgf",
+             "tests/sgf collections/three games.sgf"]
+
+    def setUp(self):
+        """
+
+        builds a catalog of the test games
+
+        :return:
+        """
+
+        self.directory = tempfile.TemporaryDirectory()
+        path = os.path.join(self.directory.name, "games.catalog")
+        self.assertEqual(9, corpus.build_catalog(self.paths, path, threads=2))
+        self.catalog = corpus.Catalog(path)
+
+    def tearDown(self):
+        """
+
+        removes the catalog
+
+        :return:
+        """
+
+        del self.catalog
+        self.directory.cleanup()
+
+    def test_player_and_komi(self):
+        """
+
+        tests to see if games can be filtered by player and komi
+
+        :return:
+        """
+
+        self.assertEqual(9, len(self.catalog))
+        self.assertEqual([0, 1, 2], self.catalog.query(player="IDW64"))
+        self.assertEqual([1, 2], self.catalog.query(player="IDW64", komi=7.5))
+        self.assertEqual([2], self.catalog.query(black="amybot-ddk"))
+        self.assertEqual([], self.catalog.query(white="amybot-ddk"))
+
+    def test_dates(self):
+        """
+
+        tests to see if games can be filtered by date
+
+        :return:
+        """
+
+        self.assertEqual([0, 1, 2, 5], self.catalog.query(date_from="2000"))
+        self.assertEqual([2], self.catalog.query(date_from="2021-07"))
+        self.assertEqual([3, 4], self.catalog.query(date_to="1987-07"))
+        self.assertEqual([5], self.catalog.query(date_from="2003", date_to="2003"))
+
+        with self.assertRaises(ValueError):
+            self.catalog.query(date_from="last year")
+
+    def test_result_and_size(self):
+        """
+
+        tests to see if games can be filtered by the winner and the size of the board
+
+        :return:
+        """
+
+        self.assertEqual([2, 3, 4, 5, 6], self.catalog.query(winner="B", size=19))
+        self.assertEqual([7], self.catalog.query(size=9))
+        self.assertEqual([7], self.catalog.query(winner="W", komi=6.5))
+
+    def test_locations_and_properties(self):
+        """
+
+        tests to see if the location and properties of a game can be found
+
+        :return:
+        """
+
+        path, game, offset, length = self.catalog.get_location(7)
+
+        self.assertEqual(("tests/sgf collections/three games.sgf", 1), (path, game))
+        with open(path) as file:
+            self.assertTrue(file.read()[offset:offset + length].startswith("(;GM[1]FF[4]SZ[9]"))
+
+        self.assertEqual({"PB": "Yasuda Shusaku", "PW": "Inoue Gennan Inseki", "BR": "4d", "WR": "8d",
+                          "DT": "1846-09-11,14,15", "RE": "B+2"}, self.catalog.get_properties(4))
+
+    def test_unreadable_files(self):
+        """
+
+        tests to see if missing files are left out rather than stopping the build
+
+        :return:
+        """
+
+        path = os.path.join(self.directory.name, "partial.catalog")
+        self.assertEqual(1, corpus.build_catalog([os.path.join(self.directory.name, "missing.sgf"),
+                                                  "tests/sgf/Ear-reddening game.sgf"], path))
+
+        catalog = corpus.Catalog(path)
+        self.assertEqual(("tests/sgf/Ear-reddening game.sgf", 0), catalog.get_location(0)[:2])
+
+    def test_write_error(self):
+        """
+
+        tests to see if a catalog that can't be saved raises an exception and that rebuilding a catalog replaces it
+
+        :return:
+        """
+
+        with self.assertRaises(OSError):
+            corpus.build_catalog(self.paths, os.path.join(self.directory.name, "missing", "games.catalog"))
+
+        path = os.path.join(self.directory.name, "partial.catalog")
+        corpus.build_catalog(self.paths, path)
+        self.assertEqual(1, corpus.build_catalog(["tests/sgf/Ear-reddening game.sgf"], path))
+
+        self.assertEqual(1, len(corpus.Catalog(path)))
+        # no temporary files are left behind
+        self.assertEqual(["games.catalog", "partial.catalog"], sorted(os.listdir(self.directory.name)))
+
+    def test_invalid_catalog(self):
+        """
+
+        tests to see if opening a file that isn't a catalog raises an exception
+
+        :return:
+        """
+
+        with self.assertRaises(sente.exceptions.InvalidSGFException):
+            corpus.Catalog("tests/sgf/3-4.sgf")
+
+
+class DataLoader(TestCase):
+
+    files = ["tests/sgf/Lee Sedol ladder game.sgf", "tests/sgf/Ear-reddening game.sgf",
+             "tests/sgf collections/three games.sgf"]
+
+    def test_batches(self):
+        """
+
+        tests to see if the batches have the right shapes and describe positions that the moves can be played in
+
+        :return:
+        """
+
+        loader = corpus.DataLoader(self.files, 32, features=["black_stones", "white_stones", "empty_points"],
+                                   threads=2, seed=7)
+
+        # the 9x9 game is left out
+        self.assertEqual(4, loader.get_game_count())
+        self.assertEqual(211 + 325 + 4 + 2, loader.get_position_count())
+
+        for _ in range(5):
+            features, moves, values = next(loader)
+
+            self.assertEqual((32, 3, 19, 19), features.shape)
+            self.assertEqual((32,), moves.shape)
+            self.assertEqual((32,), values.shape)
+
+            # every point is exactly one of black, white or empty
+            self.assertTrue(np.all(features.sum(axis=1) == 1))
+
+            for position, move in zip(features, moves):
+                if move != 19 * 19:
+                    self.assertEqual(1, position[2].flat[move])
+
+            self.assertTrue(set(values.tolist()) <= {-1.0, 0.0, 1.0})
+
+    def test_unreadable_files(self):
+        """
+
+        tests to see if missing files are left out rather than stopping the loader
+
+        :return:
+        """
+
+        loader = corpus.DataLoader(["tests/sgf/nonexistent file.sgf", "tests/sgf/Lee Sedol ladder game.sgf"], 4,
+                                   features=["black_stones"], threads=1)
+
+        self.assertEqual(1, loader.get_game_count())
+        self.assertEqual(211, loader.get_position_count())
+
+    def test_symmetries(self):
+        """
+
+        tests to see if the sampled positions are the positions of the games in some orientation
+
+        :return:
+        """
+
+        # every orientation of every position of the 19x19 games in the collection
+        expected = set()
+        for game in sgf.load_collection("tests/sgf collections/three games.sgf"):
+            if game.get_board().get_side() == 19:
+                for position in game.to_tensor(["black_stones", "white_stones"])[0]:
+                    for turns in range(4):
+                        rotated = np.rot90(position, turns, axes=(1, 2))
+                        expected.add(rotated.tobytes())
+                        expected.add(np.flip(rotated, axis=2).tobytes())
+
+        loader = corpus.DataLoader(["tests/sgf collections/three games.sgf"], 16,
+                                   features=["black_stones", "white_stones"], threads=1, seed=3)
+
+        for _ in range(4):
+            features, _, _ = next(loader)
+            for position in features:
+                self.assertIn(np.ascontiguousarray(position).tobytes(), expected)
+
+    def test_invalid_arguments(self):
+        """
+
+        tests to see if loaders that can't sample anything raise exceptions
+
+        :return:
+        """
+
+        with self.assertRaises(ValueError):
+            corpus.DataLoader(["tests/sgf collections/three games.sgf"], 0)
+
+        with self.assertRaises(ValueError):
+            corpus.DataLoader(["tests/sgf collections/three games.sgf"], 8, features=["liberties"])
+
+        with self.assertRaises(ValueError):
+            corpus.DataLoader(["tests/sgf/simple fork.sgf"], 8, side=9)
@@ -5,6 +5,9 @@ Author: Arthur Wesley
 """
 
 import os
+import gzip
+import tempfile
+import warnings
 from pathlib import Path
 from unittest import TestCase
 
@@ -326,6 +329,103 @@ class BranchedSGF(TestCase):
 
         self.assertEqual([sente.Move(14, 2, sente.stone.WHITE), sente.Move(14, 3, sente.stone.WHITE)], game.get_branches())
 
+    def test_deep_branched_sgf(self):
+        """
+
+        tests to see if very deep game trees can be loaded, walked and dumped without overflowing the stack
+
+        :return:
+        """
+
+        letters = "abcdefghijklmnopqrs"
+
+        def line(length, offset):
+            return "".join(";{}[{}{}]".format("BW"[i % 2], letters[(i + offset) % 19], letters[(i + offset) // 19 % 19])
+                           for i in range(length))
+
+        text = "(;GM[1]FF[4]SZ[19](" + line(100000, 0) + ")(" + line(100000, 7) + "))"
+
+        game = sgf.loads(text)
+
+        sequences = game.get_all_sequences()
+
+        self.assertEqual(2, len(sequences))
+        self.assertEqual([100000, 100000], [len(sequence) for sequence in sequences])
+
+        reloaded = sgf.loads(sgf.dumps(game))
+
+        self.assertEqual(sequences, reloaded.get_all_sequences())
+
+    def test_main_line_only(self):
+        """
+
+        tests to see if loading only the main line gives the first variation of the game without any side variations
+
+        :return:
+        """
+
+        for file in ["tests/sgf/simple fork.sgf", "tests/sgf/complex.sgf", "tests/sgf/3-4.sgf"]:
+            game = sgf.load(file)
+            main_line = sgf.load(file, main_line_only=True)
+
+            self.assertEqual(game.get_default_sequence(), main_line.get_default_sequence())
+            self.assertEqual([game.get_default_sequence()], main_line.get_all_sequences())
+
+    def test_lazy_variations(self):
+        """
+
+        tests to see if lazily loaded games are the same as games that are parsed all at once
+
+        :return:
+        """
+
+        for file in ["tests/sgf/simple fork.sgf", "tests/sgf/complex.sgf", "tests/sgf/3-4.sgf",
+                     "tests/sgf/ff4_ex.sgf"]:
+            game = sgf.load(file)
+            lazy = sgf.load(file, lazy_variations=True)
+
+            self.assertEqual(game.get_default_sequence(), lazy.get_default_sequence())
+            self.assertEqual(game.get_branches(), lazy.get_branches())
+            self.assertEqual(sgf.dumps(game), sgf.dumps(lazy))
+            self.assertEqual(game.get_all_sequences(), lazy.get_all_sequences())
+
+        # step into a side variation
+        game = sgf.load("tests/sgf/3-4.sgf")
+        lazy = sgf.load("tests/sgf/3-4.sgf", lazy_variations=True)
+
+        for branch in [game, lazy]:
+            branch.play(17, 4)
+            branch.play(15, 3)
+
+        self.assertEqual(game.get_branches(), lazy.get_branches())
+        self.assertEqual(game.comment, lazy.comment)
+
+    def test_lazy_variation_warnings(self):
+        """
+
+        tests to see if lazily loaded variations are checked against the file format where they start
+
+        :return:
+        """
+
+        def load_warnings(text, lazy):
+            with warnings.catch_warnings(record=True) as caught:
+                warnings.simplefilter("always")
+                sgf.loads(text, lazy_variations=lazy).get_all_sequences()
+            return [str(warning.message) for warning in caught]
+
+        # AP isn't part of FF[3], so the file is converted to FF[4] by the first variation that uses it
+        siblings = "(;FF[3]GM[1](;B[aa])(;B[bb]AP[x])(;B[cc]AP[y]))"
+        self.assertEqual(load_warnings(siblings, False), load_warnings(siblings, True))
+
+        # the variation of W[cc] comes first in the file but is parsed after the one of B[dd]
+        nested = "(;FF[3]GM[1](;B[aa](;W[bb])(;W[cc]AP[x]))(;B[dd]AP[y]))"
+        eager = load_warnings(nested, False)
+        lazy = load_warnings(nested, True)
+
+        self.assertEqual(1, len(eager))
+        self.assertIn(eager[0], lazy)
+
     def test_complex_branched_sgf(self):
         """
 
@@ -484,6 +584,17 @@ class InvalidSGFWarnings(TestCase):
         for file in files:
             sgf.load(str(Path("tests/warning sgf")/file), disable_warnings=True)
 
+    def test_warning_location(self):
+        """
+
+        tests to see if warnings report the line and column of the problem
+
+        :return:
+        """
+
+        with self.assertWarnsRegex(Warning, r'Unknown SGF Property: "JD" \(line 7, column 1\)'):
+            sgf.load("tests/warning sgf/Jappanese Date (JD) property.sgf")
+
     def test_unsupported_file_formats(self):
         """
 
@@ -535,3 +646,227 @@ class InvalidSGFWarnings(TestCase):
             sgf.load("tests/warning sgf/Jappanese Date (JD) property.sgf", ignore_illegal_properties=False)
         with self.assertRaises(sente.exceptions.InvalidSGFException):
             sgf.load("tests/warning sgf/ParkJaegeun-LeeJihyun72148.sgf", ignore_illegal_properties=False)
+
+
+class PropertyFilter(TestCase):
+
+    sgf_text = "(;GM[1]FF[4]SZ[19]PB[Black]PW[White]C[root];B[dd]C[a comment]LB[dd:A];W[pp]TR[qq])"
+
+    def test_exclude_properties(self):
+        """
+
+        tests to see if excluded properties are not loaded
+
+        :return:
+        """
+
+        game = sgf.loads(self.sgf_text, exclude_properties=["C", "LB", "TR"])
+
+        self.assertNotIn("C", game.get_properties())
+        self.assertEqual("Black", game.get_properties()["PB"])
+
+        game.play_default_sequence()
+        self.assertEqual("", game.comment)
+
+    def test_only_load_properties(self):
+        """
+
+        tests to see if only the requested properties are loaded
+
+        :return:
+        """
+
+        game = sgf.load("tests/sgf/Lee Sedol ladder game.sgf", properties=["PB"])
+
+        self.assertEqual("Lee Sedol", game.get_properties()["PB"])
+        self.assertNotIn("PW", game.get_properties())
+        self.assertNotIn("DT", game.get_properties())
+
+    def test_moves_always_loaded(self):
+        """
+
+        tests to see if filtering properties never removes the moves of the game
+
+        :return:
+        """
+
+        unfiltered = sgf.load("tests/sgf/Lee Sedol ladder game.sgf")
+        filtered = sgf.load("tests/sgf/Lee Sedol ladder game.sgf", properties=["PB"], exclude_properties=["B", "W"])
+
+        self.assertEqual(unfiltered.get_default_sequence(), filtered.get_default_sequence())
+
+    def test_unknown_property(self):
+        """
+
+        tests to see if filtering an unknown property raises an exception
+
+        :return:
+        """
+
+        with self.assertRaises(ValueError):
+            sgf.loads(self.sgf_text, exclude_properties=["not a property"])
+
+
+class CompressedSGF(TestCase):
+
+    def setUp(self):
+        self.directory = tempfile.TemporaryDirectory()
+
+    def tearDown(self):
+        self.directory.cleanup()
+
+    def test_load_gzip(self):
+        """
+
+        tests to see if a gzipped SGF file loads the same game as the uncompressed file
+
+        :return:
+        """
+
+        compressed = os.path.join(self.directory.name, "two josekis.sgf.gz")
+
+        with open("tests/sgf/two josekis.sgf", "rb") as plain, gzip.open(compressed, "wb") as output:
+            output.write(plain.read())
+
+        self.assertEqual(sgf.load("tests/sgf/two josekis.sgf").get_all_sequences(),
+                         sgf.load(compressed).get_all_sequences())
+
+    def test_dump_gzip(self):
+        """
+
+        tests to see if dumping to a ".gz" file writes a gzipped SGF file that can be loaded again
+
+        :return:
+        """
+
+        compressed = os.path.join(self.directory.name, "simple fork.sgf.gz")
+
+        game = sgf.load("tests/sgf/simple fork.sgf")
+        sgf.dump(game, compressed)
+
+        with gzip.open(compressed, "rt") as file:
+            self.assertEqual(sgf.dumps(game), file.read())
+
+        self.assertEqual(game.get_all_sequences(), sgf.load(compressed).get_all_sequences())
+
+    def test_dump_error(self):
+        """
+
+        tests to see if failing to write a file raises an error rather than losing the game
+
+        :return:
+        """
+
+        game = sgf.load("tests/sgf/simple fork.sgf")
+        missing = os.path.join(self.directory.name, "missing", "simple fork.sgf")
+
+        with self.assertRaises(OSError):
+            sgf.dump(game, missing)
+        with self.assertRaises(OSError):
+            sgf.dump(game, missing + ".gz")
+
+        if os.path.exists("/dev/full"):
+            # writing to a full disk
+            with self.assertRaises(OSError):
+                sgf.dump(game, "/dev/full")
+
+
+class Validate(TestCase):
+
+    def test_valid_files(self):
+        """
+
+        tests to see if files that can be loaded have no errors
+
+        :return:
+        """
+
+        for file in os.listdir("tests/sgf"):
+            errors = [problem for problem in sgf.validate(str(Path("tests/sgf")/file), replay=False)
+                      if problem["severity"] == "error"]
+            self.assertEqual([], errors, file)
+
+        for file in ["tests/sgf/3-4.sgf", "tests/sgf/Lee Sedol ladder game.sgf"]:
+            self.assertEqual([], sgf.validate(file))
+
+    def test_invalid_files(self):
+        """
+
+        tests to see if every file that can't be loaded has an error
+
+        :return:
+        """
+
+        for file in os.listdir("tests/invalid sgf"):
+            problems = sgf.validate(str(Path("tests/invalid sgf")/file))
+            self.assertIn("error", [problem["severity"] for problem in problems], file)
+
+    def test_error_location(self):
+        """
+
+        tests to see if errors report where they are in the file
+
+        :return:
+        """
+
+        problems = sgf.validate("tests/invalid sgf/extra square bracket.sgf")
+
+        self.assertEqual("Extra Closing Bracket", problems[0]["message"])
+        self.assertEqual(12, problems[0]["line"])
+        self.assertEqual(8, problems[0]["column"])
+
+    def test_warnings(self):
+        """
+
+        tests to see if the warnings that loading a file would issue are reported as warnings
+
+        :return:
+        """
+
+        problems = sgf.validate("tests/warning sgf/Jappanese Date (JD) property.sgf")
+
+        self.assertEqual(["warning"], [problem["severity"] for problem in problems])
+        self.assertEqual('Unknown SGF Property: "JD"', problems[0]["message"])
+
+    def test_replay(self):
+        """
+
+        tests to see if illegal moves are only found when the game is replayed
+
+        :return:
+        """
+
+        problems = sgf.validate("tests/invalid games/illegal move.sgf")
+        self.assertIn("The Desired move W R3 lies on an occupied point", [problem["message"] for problem in problems])
+
+        problems = sgf.validate("tests/invalid games/illegal move.sgf", replay=False)
+        self.assertNotIn("The Desired move W R3 lies on an occupied point",
+                         [problem["message"] for problem in problems])
+
+        problems = sgf.validate("(;GM[1]FF[4]SZ[9];B[aa];B[bb])")
+        self.assertEqual(["It is not currently black's turn"], [problem["message"] for problem in problems])
+
+    def test_replay_setup_stones(self):
+        """
+
+        tests to see if setup stones are placed on the board when the game is replayed
+
+        :return:
+        """
+
+        problems = sgf.validate("(;GM[1]FF[4]SZ[9]AB[cd];B[cd])")
+        self.assertEqual(["The Desired move B C3 lies on an occupied point"],
+                         [problem["message"] for problem in problems])
+
+        # stones surrounded by setup stones can't be played (the board is empty without them)
+        problems = sgf.validate("(;GM[1]FF[4]SZ[9]AB[ab][ba];B[cc];W[aa])")
+        self.assertEqual(["The Desired move W A0 would result in a self-capture"],
+                         [problem["message"] for problem in problems])
+
+        # AE removes setup stones
+        self.assertEqual([], sgf.validate("(;GM[1]FF[4]SZ[9]AB[cd];AE[cd];B[cd])"))
+
+        # white plays on top of a stone added with AW[pp]
+        problems = sgf.validate("tests/sgf/add stone test.sgf")
+        self.assertEqual(["The Desired move W Q15 lies on an occupied point"],
+                         [problem["message"] for problem in problems])
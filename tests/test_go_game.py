@@ -570,6 +570,51 @@ class TestTreeNavigation(TestCase):
 
         self.assertEqual(game.get_branches(), [sente.Move(2, 2, sente.stone.BLACK), sente.Move(1, 2, sente.stone.BLACK)])
 
+    def test_many_children(self):
+        """
+
+        tests to see if a node with enough children to be indexed by hash still finds its children
+
+        :return:
+        """
+
+        game = sente.Game()
+
+        # more than the 8 children that a node can have before it gets an index
+        points = [(x, y) for x in range(1, 5) for y in range(1, 4)]
+
+        for x, y in points:
+            game.play(x, y)
+            game.step_up()
+
+        branches = [sente.Move(x - 1, y - 1, sente.stone.BLACK) for x, y in points]
+        self.assertEqual(branches, game.get_branches())
+
+        # playing an existing variation again steps into it rather than adding a duplicate child
+        for x, y in reversed(points):
+            game.play(x, y)
+            self.assertEqual(sente.stone.BLACK, game.get_point(x, y))
+            self.assertEqual([], game.get_branches())
+
+            # continue each variation so that we can tell that we stepped into the existing node
+            game.play(19, 19)
+            game.step_up(2)
+
+        self.assertEqual(branches, game.get_branches())
+
+        for x, y in points:
+            game.play(x, y)
+            self.assertEqual([sente.Move(18, 18, sente.stone.WHITE)], game.get_branches())
+            game.step_up()
+
+        # children added after the node was indexed are found as well
+        game.play(10, 10)
+        game.step_up()
+        game.play(10, 10)
+        game.step_up()
+
+        self.assertEqual(branches + [sente.Move(9, 9, sente.stone.BLACK)], game.get_branches())
+
     def test_step_up_0_steps(self):
         """
 
@@ -825,3 +870,60 @@ class TestNumpy(TestCase):
 
         self.assertTrue(np.array_equal(correct_board, numpy))
 
+
+    def test_to_tensor(self):
+        """
+
+        tests to see if the tensor of a game matches the numpy arrays of each of its positions
+
+        :return:
+        """
+
+        game = sente.sgf.load("tests/sgf/Lee Sedol ladder game.sgf")
+        game.play_default_sequence()
+        game.step_up(100)
+        sequence = game.get_current_sequence()
+
+        positions, moves = game.to_tensor(["black_stones", "white_stones", "ko_points"])
+
+        self.assertEqual((211, 3, 19, 19), positions.shape)
+        self.assertEqual((211,), moves.shape)
+
+        # the board is put back where it was
+        self.assertEqual(sequence, game.get_current_sequence())
+
+        replay = sente.Game()
+
+        for i, move in enumerate(sente.sgf.load("tests/sgf/Lee Sedol ladder game.sgf").get_default_sequence()):
+            expected = replay.numpy(["black_stones", "white_stones", "ko_points"])
+            self.assertTrue(np.array_equal(np.transpose(expected, (2, 0, 1)), positions[i]))
+            self.assertEqual(move.get_x() * 19 + move.get_y(), moves[i])
+            replay.play(move)
+
+    def test_to_tensor_current_line(self):
+        """
+
+        tests to see if the tensor of the current line only contains the moves leading to the current position
+
+        :return:
+        """
+
+        game = sente.Game(9)
+
+        game.play(3, 3)
+        game.play(7, 7)
+        game.play(None)
+
+        positions, moves = game.to_tensor(["black_stones"], line="current")
+
+        self.assertEqual((3, 1, 9, 9), positions.shape)
+        self.assertEqual([2 * 9 + 2, 6 * 9 + 6, 81], list(moves))
+        self.assertEqual(1, positions[2, 0, 2, 2])
+
+        game.step_up(2)
+
+        self.assertEqual((1, 1, 9, 9), game.to_tensor(["black_stones"], line="current")[0].shape)
+        self.assertEqual((3, 1, 9, 9), game.to_tensor(["black_stones"])[0].shape)
+
+        with self.assertRaises(ValueError):
+            game.to_tensor(line="variation")